@@ -7,53 +7,20 @@
 #include <iostream>
 #include <limits>
 #include <cassert>
+#include <cstdint>
 
 /**
- * @brief Determines which of the 3 cases the angle is in with respect to a line segment from p to middle
+ * @brief Determines which of the 3 cases the angle is in with respect to a line segment from p to middle, see getCase
  * @param p The point which will form a segment with middle 
+ * @param integral Whether all coordinates are 32 bit integers, which are then compared exactly with integerTurn
  * @return The case of the point relative to the angle
  */
-Angle::Cases Angle::getLowerCase(Point &p) {
-    // Let the points of the angle be A, B, and C from left to right
-    // Is the angle just a point (Both A and C are placeholder std::numeric_limits<double>::infinity())
-    if (left.y == std::numeric_limits<double>::infinity() and right.y == std::numeric_limits<double>::infinity()){
-        return Supporting;
-    }
-    
-    // Is p on the right side of the plane BA (closed if A exists, open if A is placeholder std::numeric_limits<double>::infinity())
-    bool isRightOfBA = (left.y == std::numeric_limits<double>::infinity()) ? p.x > middle.x : not isCCW(middle, left, p);
-    // Is p on the left side of the plane BC (closed if C exists, open if C is placeholder std::numeric_limits<double>::infinity())
-    bool isLeftOfBC = (right.y == std::numeric_limits<double>::infinity()) ? p.x < middle.x : not isCW(middle, right, p); 
-    
-    if (isRightOfBA and isLeftOfBC) {
-        // If p is on the right side of BA and the left side of BC, then it is in the angle ABC
-        return Concave;
-    }
-    
-    // Reflex Case, p is in the angle opposite of ABC, this is the intersection of 2 half planes
-    if (not isRightOfBA and not isLeftOfBC) {
-        return Reflex;
-    }
-    // Otherwise must be supporting
-    return Supporting;
+Angle::Cases Angle::getLowerCase(Point &p, bool integral) {
+    return integral ? getCase<false, std::int32_t>(p) : getCase<false, double>(p);
 }
 
-Angle::Cases Angle::getUpperCase(Point &p) {
-    if (left.y == -std::numeric_limits<double>::infinity() and right.y == -std::numeric_limits<double>::infinity()){
-        return Supporting;
-    }
-
-    bool isLeftOfBA = (left.y == -std::numeric_limits<double>::infinity()) ? p.x > middle.x : not isCW(middle, left, p);
-    bool isRightOfBC = (right.y == -std::numeric_limits<double>::infinity()) ? p.x < middle.x : not isCCW(middle, right, p);
-
-    if (isLeftOfBA and isRightOfBC) {
-        return Concave;
-    }
-
-    if (not isLeftOfBA and not isRightOfBC) {
-        return Reflex;
-    }
-    return Supporting;
+Angle::Cases Angle::getUpperCase(Point &p, bool integral) {
+    return integral ? getCase<true, std::int32_t>(p) : getCase<true, double>(p);
 }
 
 /**
@@ -94,28 +61,225 @@ bool Angle::operator>=(const Angle &rhs) const {
     return !(*this < rhs);
 }
 
-std::pair<Angle::Cases, Angle::Cases> Angle::getCases(Angle leftAngle, Angle rightAngle, bool hullType) {
-    if (hullType){
-        return {leftAngle.getUpperCase(rightAngle.middle), rightAngle.getUpperCase(leftAngle.middle)};
+std::pair<Angle::Cases, Angle::Cases> Angle::getCases(Angle leftAngle, Angle rightAngle, bool hullType, bool integral) {
+    if (hullType) {
+        if (integral) return getCases<true, std::int32_t>(leftAngle, rightAngle);
+        return getCases<true, double>(leftAngle, rightAngle);
     }
-    return {leftAngle.getLowerCase(rightAngle.middle), rightAngle.getLowerCase(leftAngle.middle)};
+    if (integral) return getCases<false, std::int32_t>(leftAngle, rightAngle);
+    return getCases<false, double>(leftAngle, rightAngle);
 }
 
 bool Angle::isCCW(Point &first, Point &second, Point &third) {
-    /* HW1!
-     * Calculate determinant of:
-     * | first.x  first.y  1 |
-     * | second.x second.y 1 |
-     * | third.x  third.y  1 |
-     * If the determinant is positive, then the points are in CCW order and thus form a left turn
-     */
-    return first.x * second.y + first.y * third.x + second.x * third.y - third.x * second.y - third.y * first.x -
-           second.x * first.y > 0;
+    return turn(first, second, third) > 0;
 }
 
 
 bool Angle::isCW(Point &first, Point &second, Point &third) {
-    return first.x * second.y + first.y * third.x + second.x * third.y - third.x * second.y - third.y * first.x -
-           second.x * first.y < 0;
+    return turn(first, second, third) < 0;
+}
+
+
+// a + b as the rounded sum and its rounding error, which together represent it exactly
+static void twoSum(double a, double b, double &sum, double &error) {
+    sum = a + b;
+    double bVirtual = sum - a;
+    double aVirtual = sum - bVirtual;
+    error = (a - aVirtual) + (b - bVirtual);
 }
 
+// a * b as the rounded product and its rounding error, exact unless the product underflows
+static void twoProduct(double a, double b, double &product, double &error) {
+    product = a * b;
+    error = std::fma(a, b, -product);
+}
+
+/**
+ * @brief An exact value represented as a sum of doubles, after Shewchuk
+ * @details The terms are non zero, ordered by increasing magnitude and their bits do not overlap, so the sign of the
+ * value is the sign of the last term. A sum has at most as many terms as its operands together and a product twice the
+ * product of their lengths, so the degree 3 expression of intersectsLeftOf needs at most 192. The terms are kept in
+ * place since only the fallbacks of the predicates below use expansions, and those run in bursts on degenerate input.
+ */
+struct Expansion {
+    static const int CAPACITY = 192;
+    double terms[CAPACITY];
+    int length = 0;
+
+    Expansion() = default;
+
+    explicit Expansion(double value) {
+        if (value != 0) terms[length++] = value;
+    }
+
+    // a - b without rounding
+    static Expansion difference(double a, double b) {
+        Expansion e;
+        double d;
+        double error;
+        twoSum(a, -b, d, error);
+        if (error != 0) e.terms[e.length++] = error;
+        if (d != 0) e.terms[e.length++] = d;
+        return e;
+    }
+
+    // Adds a double, keeping the terms ordered and non overlapping
+    void grow(double b) {
+        int kept = 0;
+        for (int i = 0; i < length; i++) {
+            double error;
+            twoSum(b, terms[i], b, error);
+            if (error != 0) terms[kept++] = error;
+        }
+        assert(kept < CAPACITY);
+        if (b != 0) terms[kept++] = b;
+        length = kept;
+    }
+
+    Expansion operator+(const Expansion &rhs) const {
+        Expansion sum = *this;
+        for (int i = 0; i < rhs.length; i++) sum.grow(rhs.terms[i]);
+        return sum;
+    }
+
+    Expansion operator-(const Expansion &rhs) const {
+        Expansion difference = *this;
+        for (int i = 0; i < rhs.length; i++) difference.grow(-rhs.terms[i]);
+        return difference;
+    }
+
+    Expansion operator*(const Expansion &rhs) const {
+        Expansion product;
+        for (int i = 0; i < length; i++) {
+            for (int j = 0; j < rhs.length; j++) {
+                double p;
+                double error;
+                twoProduct(terms[i], rhs.terms[j], p, error);
+                product.grow(error);
+                product.grow(p);
+            }
+        }
+        return product;
+    }
+
+    int sign() const {
+        if (length == 0) return 0;
+        return terms[length - 1] > 0 ? 1 : -1;
+    }
+};
+
+/**
+ * @brief The sign of orientation when turn cannot trust its evaluation in doubles
+ * @param left The rounded product (second.x - first.x) (third.y - first.y)
+ * @param right The rounded product (second.y - first.y) (third.x - first.x)
+ * @details The sign is read off the rounded products if the coordinate differences were exact, and only otherwise is
+ * the determinant evaluated without rounding.
+ */
+int Angle::exactTurn(const Point &first, const Point &second, const Point &third, double left, double right) {
+    // With exact differences, as for points on a grid, rounding keeps the order of the products and equal rounded
+    // products are ordered by their rounding errors
+    double d[4];
+    double tails[4];
+    twoSum(second.x, -first.x, d[0], tails[0]);
+    twoSum(third.y, -first.y, d[1], tails[1]);
+    twoSum(second.y, -first.y, d[2], tails[2]);
+    twoSum(third.x, -first.x, d[3], tails[3]);
+    if (tails[0] == 0 and tails[1] == 0 and tails[2] == 0 and tails[3] == 0) {
+        if (left != right) return left > right ? 1 : -1;
+        double error = std::fma(d[0], d[1], -left) - std::fma(d[2], d[3], -right);
+        return (error > 0) - (error < 0);
+    }
+    Expansion exact = Expansion::difference(second.x, first.x) * Expansion::difference(third.y, first.y) -
+                      Expansion::difference(second.y, first.y) * Expansion::difference(third.x, first.x);
+    return exact.sign();
+}
+
+/**
+ * @brief Whether the lines l1 l2 and r1 r2 intersect left of the vertical line x = twiceMidLine / 2, computed exactly
+ * @details With s = num / den the intersection is r1 + s (r2 - r1), which lies left of the line when
+ * (2 r1.x - twiceMidLine) den + 2 num (r2.x - r1.x) has the opposite sign of den, see ConcatenableQueue::findBridge.
+ * The signs of den and of that expression are taken from doubles when they exceed a bound on their rounding error and
+ * evaluated without rounding otherwise. The bound is 8 eps times the expression evaluated on absolute values, which
+ * covers the at most 5 roundings along any path of the evaluation. Parallel lines, with den 0, count as intersecting
+ * right of the line. The points must be finite.
+ */
+bool Angle::intersectsLeftOf(const Point &l1, const Point &l2, const Point &r1, const Point &r2, double twiceMidLine) {
+    static const double ERROR_BOUND = 8 * 0x1p-53;
+    double lx = l2.x - l1.x;
+    double ly = l2.y - l1.y;
+    double rx = r2.x - r1.x;
+    double ry = r2.y - r1.y;
+    double ex = r1.x - l1.x;
+    double ey = r1.y - l1.y;
+    double m = 2 * r1.x - twiceMidLine;
+    double num = ex * ly - ey * lx;
+    double numBound = std::abs(ex * ly) + std::abs(ey * lx);
+    double den = ry * lx - rx * ly;
+    double denBound = std::abs(ry * lx) + std::abs(rx * ly);
+    double side = m * den + 2 * num * rx;
+    double sideBound = std::abs(m) * denBound + 2 * numBound * std::abs(rx);
+    if (std::abs(den) > ERROR_BOUND * denBound and std::abs(side) > ERROR_BOUND * sideBound) {
+        return den > 0 ? side < 0 : side > 0;
+    }
+
+    Expansion dlx = Expansion::difference(l2.x, l1.x);
+    Expansion dly = Expansion::difference(l2.y, l1.y);
+    Expansion drx = Expansion::difference(r2.x, r1.x);
+    Expansion exactNum = Expansion::difference(r1.x, l1.x) * dly - Expansion::difference(r1.y, l1.y) * dlx;
+    Expansion exactDen = Expansion::difference(r2.y, r1.y) * dlx - drx * dly;
+    Expansion exactSide = Expansion::difference(2 * r1.x, twiceMidLine) * exactDen + Expansion(2) * exactNum * drx;
+    int denSign = exactDen.sign();
+    return denSign > 0 ? exactSide.sign() < 0 : exactSide.sign() > 0;
+}
+
+// The sign of (a - b)(c - d) - (e - f)(g - h), filtered by the error bound of turn and otherwise evaluated exactly
+static int productDifferenceSign(double a, double b, double c, double d, double e, double f, double g, double h) {
+    double left = (a - b) * (c - d);
+    double right = (e - f) * (g - h);
+    double det = left - right;
+    double bound = Angle::TURN_ERROR_BOUND * (std::abs(left) + std::abs(right));
+    if (std::abs(det) > bound or bound == 0) return (det > 0) - (det < 0);
+    Expansion exact = Expansion::difference(a, b) * Expansion::difference(c, d) -
+                      Expansion::difference(e, f) * Expansion::difference(g, h);
+    return exact.sign();
+}
+
+/**
+ * @brief The sign of the cross product of a2 - a1 and b2 - b1, computed exactly
+ * @return 1 if b turns left of a, -1 if it turns right and 0 if they are parallel
+ */
+int Angle::crossSign(const Point &a1, const Point &a2, const Point &b1, const Point &b2) {
+    return productDifferenceSign(a2.x, a1.x, b2.y, b1.y, a2.y, a1.y, b2.x, b1.x);
+}
+
+/**
+ * @brief The sign of the dot product of a2 - a1 and b2 - b1, computed exactly
+ */
+int Angle::dotSign(const Point &a1, const Point &a2, const Point &b1, const Point &b2) {
+    return productDifferenceSign(a2.x, a1.x, b2.x, b1.x, a1.y, a2.y, b2.y, b1.y);
+}
+
+
+/**
+ * @brief Twice the signed area of the triangle first, second, third. Positive for a left turn, negative for a right turn.
+ * @details Computed relative to first so that the result is exactly zero whenever third equals first or second. The
+ * sign is wrong for some nearly collinear points, use turn where it must be exact.
+ */
+double Angle::orientation(const Point &first, const Point &second, const Point &third) {
+    return (second.x - first.x) * (third.y - first.y) - (second.y - first.y) * (third.x - first.x);
+}
+
+/**
+ * @brief The sign of orientation for points with 32 bit integer coordinates, computed exactly
+ * @return 1 for a left turn, -1 for a right turn and 0 if the points are collinear
+ * @details The differences need 33 bits and their products 66, so the determinant is evaluated in 128 bit integers.
+ */
+int Angle::integerTurn(const Point &first, const Point &second, const Point &third) {
+    auto x = static_cast<std::int64_t>(first.x);
+    auto y = static_cast<std::int64_t>(first.y);
+    __int128 det = static_cast<__int128>(static_cast<std::int64_t>(second.x) - x) *
+                   (static_cast<std::int64_t>(third.y) - y) -
+                   static_cast<__int128>(static_cast<std::int64_t>(second.y) - y) *
+                   (static_cast<std::int64_t>(third.x) - x);
+    return (det > 0) - (det < 0);
+}
@@ -5,7 +5,12 @@
 #ifndef DYNAMICCONVEXHULL_ANGLE_H
 #define DYNAMICCONVEXHULL_ANGLE_H
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <ostream>
+#include <type_traits>
+#include <utility>
 #include "Point.h"
 
 class Angle {
@@ -20,15 +25,41 @@ public:
     Angle(Point left, Point middle, Point right);
     Angle() = default;
     
-    Cases getLowerCase(Point &p);
-    Cases getUpperCase(Point &p);
+    Cases getLowerCase(Point &p, bool integral = false);
+    Cases getUpperCase(Point &p, bool integral = false);
+
+    template<bool Upper, class Coordinate>
+    Cases getCase(const Point &p) const;
     
     
     static bool isCCW(Point &first, Point &second, Point &third);
     
     static bool isCW(Point &first, Point &second, Point &third);
+
+    // Shewchuk's ccwerrboundA, (3 + 16 eps) eps with eps = 2^-53, a bound on the relative rounding error of orientation
+    static constexpr double TURN_ERROR_BOUND = (3.0 + 16.0 * 0x1p-53) * 0x1p-53;
+
+    static int turn(const Point &first, const Point &second, const Point &third);
+
+    static int exactTurn(const Point &first, const Point &second, const Point &third, double left, double right);
+
+    static bool intersectsLeftOf(const Point &l1, const Point &l2, const Point &r1, const Point &r2, double twiceMidLine);
+
+    static int crossSign(const Point &a1, const Point &a2, const Point &b1, const Point &b2);
+
+    static int dotSign(const Point &a1, const Point &a2, const Point &b1, const Point &b2);
+
+    static double orientation(const Point &first, const Point &second, const Point &third);
+
+    static int integerTurn(const Point &first, const Point &second, const Point &third);
     
-    static std::pair<Cases, Cases> getCases(Angle leftAngle, Angle rightAngle, bool hullType);
+    template<class Coordinate>
+    static int turnOf(const Point &first, const Point &second, const Point &third);
+
+    static std::pair<Cases, Cases> getCases(Angle leftAngle, Angle rightAngle, bool hullType, bool integral = false);
+
+    template<bool Upper, class Coordinate>
+    static std::pair<Cases, Cases> getCases(const Angle &leftAngle, const Angle &rightAngle);
 
     friend std::ostream &operator<<(std::ostream &os, const Angle &angle);
 
@@ -41,5 +72,65 @@ public:
     bool operator>=(const Angle &rhs) const;
 };
 
+/**
+ * @brief The sign of orientation, computed exactly
+ * @return 1 for a left turn, -1 for a right turn and 0 if the points are collinear
+ * @details An adaptive predicate after Shewchuk. The determinant is evaluated in doubles and its sign is trusted when
+ * it exceeds the bound on the rounding error of that evaluation, which is all but always the case for points in general
+ * position, and exactTurn decides the rest. Inline so that this common case costs no more than orientation.
+ * Coordinates must be finite and products must not underflow.
+ */
+inline int Angle::turn(const Point &first, const Point &second, const Point &third) {
+    double left = (second.x - first.x) * (third.y - first.y);
+    double right = (second.y - first.y) * (third.x - first.x);
+    double det = left - right;
+    // When the products differ in sign the bound is below |det|, and when both are 0 so is det
+    double bound = TURN_ERROR_BOUND * (std::abs(left) + std::abs(right));
+    if (std::abs(det) > bound or bound == 0) return (det > 0) - (det < 0);
+    return exactTurn(first, second, third, left, right);
+}
+
+/**
+ * @brief The sign of orientation in the arithmetic of Coordinate, integerTurn for 32 bit integers and turn for doubles
+ */
+template<class Coordinate>
+int Angle::turnOf(const Point &first, const Point &second, const Point &third) {
+    static_assert(std::is_same_v<Coordinate, double> or std::is_same_v<Coordinate, std::int32_t>);
+    if constexpr (std::is_same_v<Coordinate, std::int32_t>) {
+        return integerTurn(first, second, third);
+    } else {
+        return turn(first, second, third);
+    }
+}
+
+/**
+ * @brief Determines which of the 3 cases the angle is in with respect to a line segment from p to middle
+ * @tparam Upper Whether the angle is on an upper hull, whose placeholders are at -infinity, or on a lower hull
+ * @tparam Coordinate double, or std::int32_t if every coordinate is a 32 bit integer and is compared exactly
+ * @details Let the points of the angle be A, B and C from left to right. p is in the angle ABC, the Concave case, if it
+ * is on the inner side of both BA and BC, in the opposite angle, the Reflex case, if it is on the inner side of
+ * neither and otherwise the angle is Supporting. A missing neighbour is a placeholder and is replaced by the vertical
+ * line through B, which p must cross to count as inside. The inner side of the lower hull is above it, that of the
+ * upper hull below, which only flips the turns. An angle without neighbours is Supporting.
+ */
+template<bool Upper, class Coordinate>
+Angle::Cases Angle::getCase(const Point &p) const {
+    constexpr double placeholder = Upper ? -std::numeric_limits<double>::infinity()
+                                         : std::numeric_limits<double>::infinity();
+    constexpr int inner = Upper ? -1 : 1;
+    if (left.y == placeholder and right.y == placeholder) return Supporting;
+    bool insideBA = left.y == placeholder ? p.x > middle.x : inner * turnOf<Coordinate>(middle, left, p) <= 0;
+    bool insideBC = right.y == placeholder ? p.x < middle.x : inner * turnOf<Coordinate>(middle, right, p) >= 0;
+    if (insideBA and insideBC) return Concave;
+    if (not insideBA and not insideBC) return Reflex;
+    return Supporting;
+}
+
+template<bool Upper, class Coordinate>
+std::pair<Angle::Cases, Angle::Cases> Angle::getCases(const Angle &leftAngle, const Angle &rightAngle) {
+    return {leftAngle.getCase<Upper, Coordinate>(rightAngle.middle),
+            rightAngle.getCase<Upper, Coordinate>(leftAngle.middle)};
+}
+
 
 #endif //DYNAMICCONVEXHULL_ANGLE_H
@@ -10,6 +10,10 @@
 #include <iostream>
 #include <tuple>
 #include <limits>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
 
 
 ConcatenableQueue::~ConcatenableQueue(){
@@ -17,29 +21,41 @@ ConcatenableQueue::~ConcatenableQueue(){
 }
 
 
+/**
+ * @brief Undoes mergeHulls, returning the parts of this hull that belong to each child fragment.
+ * @details The bridge angles are restored before the split so that the subtree aggregates recomputed along the split
+ * path already see the new neighbours.
+ */
 void ConcatenableQueue::splitHull(ConcatenableQueue *left, ConcatenableQueue *right) {
     assert(rightBridge != nullptr);
     assert(leftBridge != nullptr);
+    double placeholder = (hullType == UPPER) ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+    if (left->root == nullptr) {
+        leftBridge->angle.right = leftBridge->angle.middle;
+        leftBridge->angle.right.y = placeholder;
+    } else {
+        leftBridge->angle.right = getMin(left->root)->angle.middle;
+    }
+    if (right->root == nullptr) {
+        rightBridge->angle.left = rightBridge->angle.middle;
+        rightBridge->angle.left.y = placeholder;
+    } else {
+        rightBridge->angle.left = getMax(right->root)->angle.middle;
+    }
     auto [L, R] = split(root, [&](Angle a) { return a >= rightBridge->angle; });
     assert(L != nullptr);
     assert(R != nullptr);
     root = nullptr;
     if (left->root == nullptr) {
         left->root = L;
-        leftBridge->angle.right = leftBridge->angle.middle;
-        leftBridge->angle.right.y = (hullType == UPPER) ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
     } else {
         auto [leftFragmentMin, leftFragmentRoot] = removeMin(left->root);
-        leftBridge->angle.right = leftFragmentMin->angle.middle;
         left->root = join(L, leftFragmentMin, leftFragmentRoot);
     }
     if (right->root == nullptr) {
         right->root = R;
-        rightBridge->angle.left = rightBridge->angle.middle;
-        rightBridge->angle.left.y = (hullType == UPPER) ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
     } else {
         auto [rightFragmentRoot, rightFragmentMax] = removeMax(right->root);
-        rightBridge->angle.left = rightFragmentMax->angle.middle;
         right->root = join(rightFragmentRoot, rightFragmentMax, R);
     }
     leftBridge = nullptr;
@@ -125,6 +141,7 @@ ConcatenableQueue::QNode *ConcatenableQueue::joinRight(QNode *T1, QNode *k,
         // And the minimum height node on the right spine of original T1 is one (i.e has a left child but no right child) 
         // Thus we have gone to the null pointer right child and should now return a node with value k
         k->left = k->right = nullptr;
+        updateHeight(k);
         return k;
     }
     QNode *l = T1->left;
@@ -159,6 +176,7 @@ ConcatenableQueue::joinLeft(QNode *T1, QNode *k, QNode *T2) {
         // And the maximum height node on the left spine of original T2 is one (i.e has a right child but no left child) 
         // Thus we have gone to the null pointer left child and should now return a node with value k
         k->left = k->right = nullptr;
+        updateHeight(k);
         return k;
     }
     QNode *c = T2->left;
@@ -196,8 +214,8 @@ ConcatenableQueue::QNode *ConcatenableQueue::rotateLeft(ConcatenableQueue::QNode
     QNode *r = n->right;
     n->right = r->left;
     r->left = n;
-    n->height = std::max(getHeight(n->left), getHeight(n->right)) + 1;
-    r->height = std::max(getHeight(r->left), getHeight(r->right)) + 1;
+    updateHeight(n);
+    updateHeight(r);
     return r;
 }
 
@@ -206,8 +224,8 @@ ConcatenableQueue::QNode *ConcatenableQueue::rotateRight(ConcatenableQueue::QNod
     QNode *l = n->left;
     n->left = l->right;
     l->right = n;
-    n->height = std::max(getHeight(n->left), getHeight(n->right)) + 1;
-    l->height = std::max(getHeight(l->left), getHeight(l->right)) + 1;
+    updateHeight(n);
+    updateHeight(l);
     return l;
 }
 
@@ -226,6 +244,9 @@ void ConcatenableQueue::checkProperties(ConcatenableQueue::QNode *n, Concatenabl
     assert(n->height == std::max(getHeight(n->left), getHeight(n->right)) + 1);
     assert(n->height == checkHeight(n));
     assert(std::abs(getHeight(n->left) - getHeight(n->right)) <= 1);
+    assert(n->min == (n->left == nullptr ? n : n->left->min));
+    assert(n->max == (n->right == nullptr ? n : n->right->max));
+    assert(n->size == 1 + (n->left == nullptr ? 0 : n->left->size) + (n->right == nullptr ? 0 : n->right->size));
     checkProperties(n->left, min, n);
     checkProperties(n->right, n, max);
 
@@ -239,15 +260,35 @@ int ConcatenableQueue::checkHeight(ConcatenableQueue::QNode *n) {
 using
 enum Angle::Cases;
 
-std::pair<ConcatenableQueue::QNode *, ConcatenableQueue::QNode *>
-ConcatenableQueue::findBridge(ConcatenableQueue *left, ConcatenableQueue *right) {
-    QNode *l = left->root;
-    QNode *r = right->root; 
-    assert(l != nullptr and r != nullptr);
-    double maxLeft = getMax(l)->angle.middle.x;
-    double minRight = getMin(r)->angle.middle.x;
-    double midLine = 0.5 * (maxLeft + minRight);
-    auto [lCase, rCase] = Angle::getCases(l->angle, r->angle, hullType);
+using QNode = ConcatenableQueue::QNode;
+
+/**
+ * @brief Whether the lines l1 l2 and r1 r2 intersect left of the vertical line x = twiceMidLine / 2, see findBridge
+ * @details With integral coordinates the products need up to 98 bits and are evaluated exactly in 128 bit integers,
+ * otherwise by the adaptive Angle::intersectsLeftOf. The lines are nearly parallel whenever the points are nearly
+ * collinear, where rounding could flip the result and send the search off the hull.
+ */
+template<class Coordinate>
+static bool intersectsLeftOf(const Point &l1, const Point &l2, const Point &r1, const Point &r2, double twiceMidLine) {
+    if constexpr (std::is_same_v<Coordinate, std::int32_t>) {
+        auto i = [](double v) { return static_cast<__int128>(static_cast<std::int64_t>(v)); };
+        __int128 num = (i(r1.x) - i(l1.x)) * (i(l2.y) - i(l1.y)) - (i(r1.y) - i(l1.y)) * (i(l2.x) - i(l1.x));
+        __int128 den = (i(r2.y) - i(r1.y)) * (i(l2.x) - i(l1.x)) - (i(r2.x) - i(r1.x)) * (i(l2.y) - i(l1.y));
+        __int128 side = (2 * i(r1.x) - i(twiceMidLine)) * den + 2 * num * (i(r2.x) - i(r1.x));
+        return den > 0 ? side < 0 : side > 0;
+    } else {
+        return Angle::intersectsLeftOf(l1, l2, r1, r2, twiceMidLine);
+    }
+}
+
+/**
+ * @brief The bridge search of findBridge for one hull side and coordinate type
+ * @details Instantiated for each combination so that the side and the arithmetic are fixed at compile time and the
+ * case tests inline into the loop, which runs O(log n) times per bridge.
+ */
+template<bool Upper, class Coordinate>
+static std::pair<QNode *, QNode *> bridge(QNode *l, QNode *r, double twiceMidLine) {
+    auto [lCase, rCase] = Angle::getCases<Upper, Coordinate>(l->angle, r->angle);
     while (lCase != Supporting or rCase != Supporting) {
         if (lCase == Supporting) {
             r = (rCase == Concave) ? r->left : r->right;
@@ -276,32 +317,377 @@ ConcatenableQueue::findBridge(ConcatenableQueue *left, ConcatenableQueue *right)
              t(l2.x - l1.x) - s(r2.x - r1.x) = r1.x - l1.x
              t(l2.y - l1.y) - s(r2.y - r1.y) = r1.y - l1.y
              Solve for s
-             t = (r1.x - l1.x + s(r2.x - r1.x)) / (l2.x - l1.x)
-             t = (r1.y - l1.y + s(r2.y - r1.y)) / (l2.y - l1.y)
-             (r1.x - l1.x + s(r2.x - r1.x)) / (l2.x - l1.x) = (r1.y - l1.y + s(r2.y - r1.y)) / (l2.y - l1.y)
-             (r1.x - l1.x)(l2.y - l1.y) + s(r2.x - r1.x)(l2.y - l1.y) = (r1.y - l1.y)(l2.x - l1.x) + s(r2.y - r1.y)(l2.x - l1.x)
              s = ((r1.x - l1.x)(l2.y - l1.y) - (r1.y - l1.y)(l2.x - l1.x)) / ((r2.y - r1.y)(l2.x - l1.x) - (r2.x - r1.x)(l2.y - l1.y))
-             Plug s back into parametric equation to get x - intersection
-             x = r1.x + s(r2.x - r1.x)
+             The x - intersection is x = r1.x + s(r2.x - r1.x), so with s = num / den
+             x < midLine  <=>  (2 r1.x - (maxLeft + minRight)) den + 2 num (r2.x - r1.x) has the opposite sign of den
+             which needs no division. Parallel lines only occur when all four points are collinear, then den and num
+             are 0 and the right hull moves as before.
              */
-
-            double s = ((r1.x - l1.x) * (l2.y - l1.y) - (r1.y - l1.y) * (l2.x - l1.x)) /
-                       ((r2.y - r1.y) * (l2.x - l1.x) - (r2.x - r1.x) * (l2.y - l1.y));
-            double x = r1.x + s * (r2.x - r1.x);
-
-            if (x < midLine) {
+            if (intersectsLeftOf<Coordinate>(l1, l2, r1, r2, twiceMidLine)) {
                 l = l->right;
             } else {
                 r = r->left;
             }
         }
         assert(l != nullptr and r != nullptr);
-        std::tie(lCase, rCase) = Angle::getCases(l->angle, r->angle, hullType);
+        std::tie(lCase, rCase) = Angle::getCases<Upper, Coordinate>(l->angle, r->angle);
     }
-    assert(l != nullptr and r != nullptr);
     return {l, r};
 }
 
+/**
+ * @brief Finds the bridge between the hulls left and right, whose vertices are all left of those of right
+ * @details The only test of hullType and integral in a merge, it selects the instantiation of bridge once per call.
+ * When several vertices of a hull lie on the bridge line the search stops at any of them, so the bridge is moved to
+ * the innermost ones. Every merged hull then keeps exactly the points on its boundary, which does not depend on the
+ * shape of the trees and lets an update change the hull only where it is visible from the point.
+ */
+std::pair<ConcatenableQueue::QNode *, ConcatenableQueue::QNode *>
+ConcatenableQueue::findBridge(ConcatenableQueue *left, ConcatenableQueue *right) {
+    assert(left->root != nullptr and right->root != nullptr);
+    double twiceMidLine = getMax(left->root)->angle.middle.x + getMin(right->root)->angle.middle.x;
+    std::pair<QNode *, QNode *> found;
+    if (hullType == UPPER) {
+        found = integral ? bridge<UPPER, std::int32_t>(left->root, right->root, twiceMidLine)
+                         : bridge<UPPER, double>(left->root, right->root, twiceMidLine);
+    } else {
+        found = integral ? bridge<LOWER, std::int32_t>(left->root, right->root, twiceMidLine)
+                         : bridge<LOWER, double>(left->root, right->root, twiceMidLine);
+    }
+    auto [l, r] = found;
+    const Point a = l->angle.middle;
+    const Point b = r->angle.middle;
+    if (not std::isinf(l->angle.right.y) and Angle::turn(a, b, l->angle.right) == 0) {
+        l = left->findLineEnd(a, b, l, true);
+    }
+    if (not std::isinf(r->angle.left.y) and Angle::turn(a, b, r->angle.left) == 0) {
+        r = right->findLineEnd(a, b, r, false);
+    }
+    return {l, r};
+}
+
+/**
+ * @brief Finds the last vertex on the line through a and b of the run of vertices on it that contains from
+ * @param forward Whether to search right of from or left of it
+ * @details The hull lies on one side of the line, so the vertices on it are contiguous, O(log h).
+ */
+ConcatenableQueue::QNode *ConcatenableQueue::findLineEnd(const Point &a, const Point &b, QNode *from, bool forward) {
+    QNode *end = from;
+    QNode *n = root;
+    while (n != nullptr) {
+        bool outward = forward ? not (n->angle < from->angle) : not (n->angle > from->angle);
+        if (outward and Angle::turn(a, b, n->angle.middle) == 0) {
+            end = n;
+            n = forward ? n->right : n->left;
+        } else if (outward) {
+            n = forward ? n->left : n->right;
+        } else {
+            n = forward ? n->right : n->left;
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief Determines whether the edge from n to its right neighbour is visible from p, that is p is strictly below the
+ * edge of a lower hull or strictly above the edge of an upper hull.
+ */
+bool ConcatenableQueue::isVisible(ConcatenableQueue::QNode *n, const Point &p) {
+    if (std::isinf(n->angle.right.y)) return false;
+    int turn = Angle::turn(n->angle.middle, n->angle.right, p);
+    return (hullType == UPPER) ? turn > 0 : turn < 0;
+}
+
+/**
+ * @brief Finds the first and last edges of the hull that are visible from p.
+ * @param p The query point
+ * @return The nodes whose edges to their right neighbours are the first and last visible edges, or nullptrs if no edge
+ * is visible.
+ * @details Evaluated at p.x, the lines through the edges of a hull are unimodal with the peak at the edge spanning p.x,
+ * so the visible edges are contiguous and contain that edge. Edges left of the first visible edge end at or left of
+ * p.x while edges right of the last visible edge end right of it, which makes both searches a single descent. A
+ * vertical edge at p.x is collinear with p and never visible. Such edges only occur at the ends of a hull, the
+ * remaining edges lie right of it only at the left end.
+ */
+std::pair<ConcatenableQueue::QNode *, ConcatenableQueue::QNode *>
+ConcatenableQueue::findVisibleEdges(const Point &p) {
+    if (root == nullptr) return {nullptr, nullptr};
+    double minX = root->min->angle.middle.x;
+    // Whether the edge of a node that is not visible lies left of the visible edges
+    auto leftOfVisible = [&](QNode *n) {
+        if (std::isinf(n->angle.right.y) or n->angle.right.x > p.x) return false;
+        return n->angle.middle.x < p.x or n->angle.middle.x == minX;
+    };
+    QNode *first = nullptr;
+    QNode *n = root;
+    while (n != nullptr) {
+        if (isVisible(n, p)) {
+            first = n;
+            n = n->left;
+        } else if (leftOfVisible(n)) {
+            n = n->right;
+        } else {
+            n = n->left;
+        }
+    }
+    if (first == nullptr) return {nullptr, nullptr};
+    QNode *last = nullptr;
+    n = root;
+    while (n != nullptr) {
+        if (isVisible(n, p)) {
+            last = n;
+            n = n->right;
+        } else if (leftOfVisible(n)) {
+            n = n->right;
+        } else {
+            n = n->left;
+        }
+    }
+    return {first, last};
+}
+
+/**
+ * @brief Finds the vertex of the hull that maximizes the dot product with direction.
+ * @param direction The direction to maximize in, treated as a vector
+ * @param tieBreak Decides between vertices with equal dot products, the one maximizing the dot product with tieBreak
+ * is returned
+ * @return The node of a maximizing vertex, nullptr if the hull is empty
+ * @details Along a hull the dot product is unimodal, so each node only needs to compare the direction with its two
+ * stored edges to know which side the maximum is on.
+ */
+ConcatenableQueue::QNode *ConcatenableQueue::findExtreme(const Point &direction, const Point &tieBreak) {
+    // The sign of the change along the edge from p to q, with ties broken by tieBreak
+    auto change = [&](const Point &p, const Point &q) {
+        double dot = direction.x * (q.x - p.x) + direction.y * (q.y - p.y);
+        if (dot == 0) dot = tieBreak.x * (q.x - p.x) + tieBreak.y * (q.y - p.y);
+        return (dot > 0) - (dot < 0);
+    };
+    QNode *n = root;
+    while (n != nullptr) {
+        Angle &a = n->angle;
+        if (not std::isinf(a.right.y) and change(a.middle, a.right) > 0) {
+            n = n->right;
+        } else if (not std::isinf(a.left.y) and change(a.left, a.middle) < 0) {
+            n = n->left;
+        } else {
+            return n;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Finds the last node between from and to that is strictly on the same side of the line through a and b as
+ * from. The side of the line must be monotone between from and to.
+ * @return The node whose edge to its right neighbour crosses the line, from itself if from is on the line.
+ */
+ConcatenableQueue::QNode *ConcatenableQueue::findSideChange(const Point &a, const Point &b, QNode *from, QNode *to) {
+    int side = Angle::turn(a, b, from->angle.middle);
+    if (side == 0) return from;
+    QNode *last = from;
+    QNode *n = root;
+    while (n != nullptr) {
+        if (n->angle < from->angle) {
+            n = n->right;
+        } else if (n->angle > to->angle) {
+            n = n->left;
+        } else if (Angle::turn(a, b, n->angle.middle) == side) {
+            last = n;
+            n = n->right;
+        } else {
+            n = n->left;
+        }
+    }
+    return last;
+}
+
+static double segmentDistance(const Point &p, const Point &a, const Point &b) {
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    double lengthSquared = dx * dx + dy * dy;
+    double t = lengthSquared == 0 ? 0 : std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared, 0.0, 1.0);
+    return std::hypot(p.x - a.x - t * dx, p.y - a.y - t * dy);
+}
+
+/**
+ * @brief The distance from p to the edge of n, or to its vertex if it is the last one of the hull
+ */
+double ConcatenableQueue::edgeDistance(ConcatenableQueue::QNode *n, const Point &p) {
+    if (std::isinf(n->angle.right.y)) return std::hypot(p.x - n->angle.middle.x, p.y - n->angle.middle.y);
+    return segmentDistance(p, n->angle.middle, n->angle.right);
+}
+
+/**
+ * @brief Finds the edge between first and last that is nearest to p, where p sees every edge from first to last.
+ * @details Seen from p the nearest point of a visible run of edges is further along than the end of every edge before
+ * it and behind the start of every edge after it, so projecting p onto an edge tells which side to search. O(log h).
+ */
+ConcatenableQueue::QNode *ConcatenableQueue::findNearestEdge(const Point &p, QNode *first, QNode *last) {
+    QNode *best = nullptr;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    QNode *n = root;
+    while (n != nullptr) {
+        if (n->angle < first->angle) {
+            n = n->right;
+            continue;
+        }
+        if (n->angle > last->angle) {
+            n = n->left;
+            continue;
+        }
+        double distance = edgeDistance(n, p);
+        if (distance < bestDistance) {
+            best = n;
+            bestDistance = distance;
+        }
+        const Point &a = n->angle.middle;
+        const Point &b = n->angle.right;
+        double dx = b.x - a.x;
+        double dy = b.y - a.y;
+        if ((p.x - b.x) * dx + (p.y - b.y) * dy > 0) {
+            n = n->right;
+        } else if ((p.x - a.x) * dx + (p.y - a.y) * dy < 0) {
+            n = n->left;
+        } else {
+            break;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief A triangle containing the vertices and edges of the subtree rooted at n
+ * @param corners Filled with the corners of the triangle, fewer when it degenerates to a segment or a point
+ * @return The number of corners
+ * @details The subtree is a convex piece of the hull, so it lies between the segment joining its ends and the lines
+ * through its first and last edges.
+ */
+int ConcatenableQueue::cap(ConcatenableQueue::QNode *n, Point corners[3]) {
+    const Angle &first = n->min->angle;
+    const Angle &last = n->max->angle;
+    corners[0] = first.middle;
+    if (std::isinf(first.right.y)) return 1;
+    Point firstDirection(first.right.x - first.middle.x, first.right.y - first.middle.y);
+    Point lastDirection;
+    if (std::isinf(last.right.y)) {
+        corners[1] = last.middle;
+        lastDirection = Point(last.middle.x - last.left.x, last.middle.y - last.left.y);
+    } else {
+        corners[1] = last.right;
+        lastDirection = Point(last.right.x - last.middle.x, last.right.y - last.middle.y);
+    }
+    double cross = firstDirection.x * lastDirection.y - firstDirection.y * lastDirection.x;
+    if (cross == 0) return 2;
+    double t = ((corners[1].x - corners[0].x) * lastDirection.y - (corners[1].y - corners[0].y) * lastDirection.x) /
+               cross;
+    corners[2] = Point(corners[0].x + t * firstDirection.x, corners[0].y + t * firstDirection.y);
+    return 3;
+}
+
+/**
+ * @brief A lower bound on the distance from p to the edges of the subtree rooted at n
+ */
+double ConcatenableQueue::capDistance(ConcatenableQueue::QNode *n, const Point &p) {
+    Point corners[3];
+    int count = cap(n, corners);
+    if (count == 1) return std::hypot(p.x - corners[0].x, p.y - corners[0].y);
+    if (count == 2) return segmentDistance(p, corners[0], corners[1]);
+    int s0 = Angle::turn(corners[0], corners[1], p);
+    int s1 = Angle::turn(corners[1], corners[2], p);
+    int s2 = Angle::turn(corners[2], corners[0], p);
+    if ((s0 >= 0 and s1 >= 0 and s2 >= 0) or (s0 <= 0 and s1 <= 0 and s2 <= 0)) return 0;
+    return std::min({segmentDistance(p, corners[0], corners[1]), segmentDistance(p, corners[1], corners[2]),
+                     segmentDistance(p, corners[2], corners[0])});
+}
+
+/**
+ * @brief An upper bound on the distance from p to the vertices of the subtree rooted at n
+ */
+double ConcatenableQueue::capFarthestDistance(ConcatenableQueue::QNode *n, const Point &p) {
+    Point corners[3];
+    int count = cap(n, corners);
+    double distance = 0;
+    for (int i = 0; i < count; ++i) {
+        distance = std::max(distance, std::hypot(p.x - corners[i].x, p.y - corners[i].y));
+    }
+    return distance;
+}
+
+/**
+ * @brief Branch and bound search for the edge nearest to p in the subtree rooted at n, improving on best
+ * @details Subtrees whose caps are no closer than the best edge so far are skipped and the closer child is searched
+ * first. The distance to the boundary from inside is not unimodal along the hull, so no single descent finds it, but
+ * caps shrink quickly with depth and typically only a few paths are followed. O(h) in the worst case.
+ */
+void ConcatenableQueue::nearestEdge(ConcatenableQueue::QNode *n, const Point &p, QNode *&best, double &bestDistance) {
+    if (n == nullptr or capDistance(n, p) >= bestDistance) return;
+    double distance = edgeDistance(n, p);
+    if (distance < bestDistance) {
+        best = n;
+        bestDistance = distance;
+    }
+    QNode *first = n->left;
+    QNode *second = n->right;
+    if (first == nullptr or (second != nullptr and capDistance(second, p) < capDistance(first, p))) {
+        std::swap(first, second);
+    }
+    nearestEdge(first, p, best, bestDistance);
+    nearestEdge(second, p, best, bestDistance);
+}
+
+/**
+ * @brief Branch and bound search for the vertex farthest from p in the subtree rooted at n, improving on best
+ * @details The mirror image of nearestEdge, bounded by the farthest corner of each cap. Distances from a point to
+ * the vertices of a convex polygon can have several local maxima, so this too is O(h) in the worst case.
+ */
+void ConcatenableQueue::farthestVertex(ConcatenableQueue::QNode *n, const Point &p, QNode *&best,
+                                       double &bestDistance) {
+    if (n == nullptr or capFarthestDistance(n, p) <= bestDistance) return;
+    double distance = std::hypot(p.x - n->angle.middle.x, p.y - n->angle.middle.y);
+    if (distance > bestDistance) {
+        best = n;
+        bestDistance = distance;
+    }
+    QNode *first = n->left;
+    QNode *second = n->right;
+    if (first == nullptr or (second != nullptr and capFarthestDistance(second, p) > capFarthestDistance(first, p))) {
+        std::swap(first, second);
+    }
+    farthestVertex(first, p, best, bestDistance);
+    farthestVertex(second, p, best, bestDistance);
+}
+
+/**
+ * @brief Finds the edges of the hull crossed by the line through a and b.
+ * @param edges Filled with the nodes whose edges to their right neighbours cross the line
+ * @return The number of edges found, a line touching a vertex or running along an edge may be reported more than once
+ * @details The side of the line is a linear function, so along the hull it only changes direction at the vertices
+ * furthest on either side of the line. Between those two vertices and the ends of the hull it is monotone and each
+ * piece is crossed at most once, found with findSideChange. O(log h) in total.
+ */
+int ConcatenableQueue::findCrossingEdges(const Point &a, const Point &b, QNode *edges[3]) {
+    if (root == nullptr) return 0;
+    Point normal(a.y - b.y, b.x - a.x);
+    QNode *above = findExtreme(normal);
+    QNode *below = findExtreme(Point(-normal.x, -normal.y));
+    QNode *pieces[4] = {getMin(root), std::min(above, below, [](QNode *l, QNode *r) { return l->angle < r->angle; }),
+                        std::max(above, below, [](QNode *l, QNode *r) { return l->angle < r->angle; }), getMax(root)};
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+        QNode *from = pieces[i];
+        QNode *to = pieces[i + 1];
+        int fromSide = Angle::turn(a, b, from->angle.middle);
+        int toSide = Angle::turn(a, b, to->angle.middle);
+        if ((fromSide > 0 and toSide > 0) or (fromSide < 0 and toSide < 0)) continue;
+        if (from == to) continue;
+        edges[count++] = findSideChange(a, b, from, to);
+    }
+    if (isLeaf(root) and Angle::turn(a, b, root->angle.middle) == 0) {
+        edges[count++] = root;
+    }
+    return count;
+}
+
 void ConcatenableQueue::inOrder(ConcatenableQueue::QNode *n) {
     if (n == nullptr) return;
     inOrder(n->left);
@@ -311,21 +697,76 @@ void ConcatenableQueue::inOrder(ConcatenableQueue::QNode *n) {
 }
 
 
+/**
+ * @brief Recomputes the height and the subtree aggregates of n from its children and its own edge.
+ */
 void ConcatenableQueue::updateHeight(ConcatenableQueue::QNode *&n) {
     n->height = std::max(getHeight(n->left), getHeight(n->right)) + 1;
+    n->size = 1;
+    n->crossSum = 0;
+    n->lengthSum = 0;
+    n->min = n;
+    n->max = n;
+    Angle &a = n->angle;
+    if (not std::isinf(a.right.y)) {
+        n->crossSum = a.middle.x * a.right.y - a.right.x * a.middle.y;
+        n->lengthSum = std::hypot(a.right.x - a.middle.x, a.right.y - a.middle.y);
+    }
+    if (n->left != nullptr) {
+        n->size += n->left->size;
+        n->crossSum += n->left->crossSum;
+        n->lengthSum += n->left->lengthSum;
+        n->min = n->left->min;
+    }
+    if (n->right != nullptr) {
+        n->size += n->right->size;
+        n->crossSum += n->right->crossSum;
+        n->lengthSum += n->right->lengthSum;
+        n->max = n->right->max;
+    }
+}
+
+int ConcatenableQueue::size() {
+    return root == nullptr ? 0 : root->size;
+}
+
+double ConcatenableQueue::crossSum() {
+    return root == nullptr ? 0 : root->crossSum;
+}
+
+double ConcatenableQueue::lengthSum() {
+    return root == nullptr ? 0 : root->lengthSum;
 }
 
 
 ConcatenableQueue::QNode *ConcatenableQueue::getMax(ConcatenableQueue::QNode *n) {
     if (n == nullptr) return nullptr;
-    if (n->right == nullptr) return n;
-    return getMax(n->right);
+    return n->max;
 }
 
 ConcatenableQueue::QNode *ConcatenableQueue::getMin(ConcatenableQueue::QNode *n) {
     if (n == nullptr) return nullptr;
-    if (n->left == nullptr) return n;
-    return getMin(n->left);
+    return n->min;
+}
+
+/**
+ * @brief Finds the hull edge spanning the vertical line at x without leaving the tree.
+ * @param n The root of a hull
+ * @param x The x coordinate to search for
+ * @return The node whose edge from angle.middle to angle.right spans x, the rightmost vertex if x is at or beyond
+ * it (its right neighbour is a placeholder), or nullptr if x is left of the hull.
+ */
+ConcatenableQueue::QNode *ConcatenableQueue::findEdge(ConcatenableQueue::QNode *n, double x) {
+    while (n != nullptr) {
+        if (x < n->angle.middle.x) {
+            n = n->left;
+        } else if (std::isinf(n->angle.right.y) or x <= n->angle.right.x) {
+            return n;
+        } else {
+            n = n->right;
+        }
+    }
+    return nullptr;
 }
 
 /**
@@ -356,12 +797,14 @@ void ConcatenableQueue::mergeHulls(ConcatenableQueue *left, ConcatenableQueue *r
     assert(rightBridge != nullptr);
     Angle &leftBridgeAngle = leftBridge->angle;
     Angle &rightBridgeAngle = rightBridge->angle;
+    // Split compares angles by their middle point only, so the bridge can be connected first. The splits then pass
+    // through both bridge nodes and recompute their aggregates.
+    leftBridgeAngle.right = rightBridgeAngle.middle;
+    rightBridgeAngle.left = leftBridgeAngle.middle;
     auto [leftLeft, leftRight] = split(left->root, [&](Angle a) { return a > leftBridgeAngle; });
     auto [rightLeft, rightRight] = split(right->root, [&](Angle a) { return a >= rightBridgeAngle; });
     left->root = leftRight;
     right->root = rightLeft;
-    leftBridgeAngle.right = rightBridgeAngle.middle;
-    rightBridgeAngle.left = leftBridgeAngle.middle;
     assert(leftLeft != nullptr);
     assert(rightRight != nullptr);
     root = join2(leftLeft, rightRight);
@@ -372,15 +815,17 @@ ConcatenableQueue::QNode::QNode(ConcatenableQueue::QNode *l, Angle a, Concatenab
     left = l;
     right = r;
     angle = a;
-    height = std::max(getHeight(l), getHeight(r)) + 1;
+    QNode *self = this;
+    updateHeight(self);
 }
 
 
 ConcatenableQueue::QNode::QNode(Angle a) {
     angle = a;
-    height = 0;
     left = nullptr;
     right = nullptr;
+    QNode *self = this;
+    updateHeight(self);
 }
 
 void ConcatenableQueue::getPoints(ConcatenableQueue::QNode *n, std::vector<Point> &points) {
@@ -401,3 +846,79 @@ void ConcatenableQueue::recycle(ConcatenableQueue::QNode *n) {
     recycle(n->right);
     delete n;
 }
+
+ConcatenableQueue::Iterator ConcatenableQueue::Iterator::first(ConcatenableQueue::QNode *root) {
+    Iterator it;
+    for (QNode *n = root; n != nullptr; n = n->left) it.push(n);
+    return it;
+}
+
+ConcatenableQueue::Iterator ConcatenableQueue::Iterator::last(ConcatenableQueue::QNode *root) {
+    Iterator it;
+    for (QNode *n = root; n != nullptr; n = n->right) it.push(n);
+    return it;
+}
+
+/**
+ * @brief Positions the iterator at the node storing p, the iterator is invalid if p is not in the queue.
+ */
+ConcatenableQueue::Iterator ConcatenableQueue::Iterator::find(ConcatenableQueue::QNode *root, const Point &p) {
+    Iterator it;
+    for (QNode *n = root; n != nullptr; n = (p < n->angle.middle) ? n->left : n->right) {
+        it.push(n);
+        if (n->angle.middle == p) return it;
+    }
+    return Iterator();
+}
+
+void ConcatenableQueue::Iterator::push(ConcatenableQueue::QNode *n) {
+    assert(depth < MAX_DEPTH);
+    path[depth++] = n;
+}
+
+bool ConcatenableQueue::Iterator::valid() const {
+    return depth > 0;
+}
+
+ConcatenableQueue::QNode *ConcatenableQueue::Iterator::node() const {
+    return depth > 0 ? path[depth - 1] : nullptr;
+}
+
+/**
+ * @brief Moves to the in order successor, the iterator becomes invalid after the maximum.
+ */
+void ConcatenableQueue::Iterator::next() {
+    QNode *n = path[depth - 1];
+    if (n->right != nullptr) {
+        for (n = n->right; n != nullptr; n = n->left) push(n);
+        return;
+    }
+    // Climb until we leave a left subtree, that ancestor is the successor
+    QNode *child;
+    do {
+        child = path[--depth];
+    } while (depth > 0 and path[depth - 1]->right == child);
+}
+
+/**
+ * @brief Moves to the in order predecessor, the iterator becomes invalid before the minimum.
+ */
+void ConcatenableQueue::Iterator::prev() {
+    QNode *n = path[depth - 1];
+    if (n->left != nullptr) {
+        for (n = n->left; n != nullptr; n = n->right) push(n);
+        return;
+    }
+    QNode *child;
+    do {
+        child = path[--depth];
+    } while (depth > 0 and path[depth - 1]->left == child);
+}
+
+bool ConcatenableQueue::Iterator::operator==(const ConcatenableQueue::Iterator &rhs) const {
+    return node() == rhs.node();
+}
+
+bool ConcatenableQueue::Iterator::operator!=(const ConcatenableQueue::Iterator &rhs) const {
+    return not (rhs == *this);
+}
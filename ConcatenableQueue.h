@@ -22,6 +22,14 @@ public:
         QNode *left;
         QNode *right;
         int height;
+        
+        // Aggregates of the subtree, the edge of a node runs from angle.middle to angle.right when right is not a 
+        // placeholder. Kept current by updateHeight.
+        int size;
+        double crossSum;  // Sum of the cross products of the edges' endpoints, twice the signed area they sweep
+        double lengthSum; // Sum of the edge lengths
+        QNode *min;
+        QNode *max;
 
         QNode(Angle a);
 
@@ -31,10 +39,52 @@ public:
 
     };
 
+    /**
+     * @brief An in order iterator over a QNode tree that keeps the path from the root on a fixed size stack, so it can
+     * move in both directions without recursion or allocation.
+     */
+    class Iterator {
+    public:
+        static const int MAX_DEPTH = 128;
+
+        Iterator() = default;
+
+        static Iterator first(QNode *root);
+
+        static Iterator last(QNode *root);
+
+        static Iterator find(QNode *root, const Point &p);
+
+        bool valid() const;
+
+        QNode *node() const;
+
+        void next();
+
+        void prev();
+
+        bool operator==(const Iterator &rhs) const;
+
+        bool operator!=(const Iterator &rhs) const;
+
+    private:
+        QNode *path[MAX_DEPTH];
+        int depth = 0;
+
+        void push(QNode *n);
+    };
+
     QNode *leftBridge = nullptr;
     QNode *rightBridge = nullptr;
     QNode *root;
     bool hullType;
+    // Whether every coordinate is a 32 bit integer, which makes findBridge use exact integer predicates
+    bool integral = false;
+    // hullType and integral stay runtime fields because TTree keeps a lower and an upper hull in every node and a tree
+    // chooses its coordinate mode when it is built. Updates test them once per call: mergeHulls selects the bridge
+    // search instantiated for the side and arithmetic through findBridge, and splitHull picks its placeholder. The
+    // bridge loop and its case tests read neither, only the placeholders of the angles they visit. isVisible still
+    // reads hullType for every edge a visibility query tests.
 
     /**
     * @brief Splits the tree rooted at T into two parts, a tree of values lower than k, and a tree of values higher than k.
@@ -72,6 +122,7 @@ public:
     
     static QNode *getMax(QNode *n);
     static QNode *getMin(QNode *n);
+    static QNode *findEdge(QNode *n, double x);
 
 
     static void inOrder(QNode *n);
@@ -79,6 +130,10 @@ public:
     static void getPoints(QNode *n, std::vector<Point> &points);
 
     static void updateHeight(QNode *&n);
+    
+    int size();
+    double crossSum();
+    double lengthSum();
 
     static std::pair<QNode *, QNode *> removeMax(QNode *n);
     static std::pair<QNode *, QNode *> removeMin(QNode *n);
@@ -105,6 +160,20 @@ public:
     void splitHull(ConcatenableQueue *left, ConcatenableQueue *right);
 
     std::pair<QNode *, QNode *> findBridge(ConcatenableQueue *left, ConcatenableQueue *right);
+
+    bool isVisible(QNode *n, const Point &p);
+    std::pair<QNode *, QNode *> findVisibleEdges(const Point &p);
+    QNode *findExtreme(const Point &direction, const Point &tieBreak = Point(0, 0));
+    QNode *findSideChange(const Point &a, const Point &b, QNode *from, QNode *to);
+    QNode *findLineEnd(const Point &a, const Point &b, QNode *from, bool forward);
+    int findCrossingEdges(const Point &a, const Point &b, QNode *edges[3]);
+    QNode *findNearestEdge(const Point &p, QNode *first, QNode *last);
+    static double edgeDistance(QNode *n, const Point &p);
+    static int cap(QNode *n, Point corners[3]);
+    static double capDistance(QNode *n, const Point &p);
+    static double capFarthestDistance(QNode *n, const Point &p);
+    static void nearestEdge(QNode *n, const Point &p, QNode *&best, double &bestDistance);
+    static void farthestVertex(QNode *n, const Point &p, QNode *&best, double &bestDistance);
     void recycle(QNode *n);
     
     friend class TTree;
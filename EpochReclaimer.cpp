@@ -0,0 +1,67 @@
+/**
+ * @file EpochReclaimer.cpp
+ * @date 10/19/26
+ * @details The writer publishes a new version with an atomic store and then retires whatever the old version no
+ * longer shares, tagged with the current epoch. A reader announces the epoch in its slot before loading the published
+ * pointer, so anything it can reach was retired in that epoch or later. Advancing the epoch frees everything retired
+ * before the oldest announced epoch. All operations are sequentially consistent, which orders the announcement of a
+ * reader before its load and the store of the writer before its scan of the slots.
+ */
+
+#include "EpochReclaimer.h"
+#include <algorithm>
+#include <cassert>
+
+EpochReclaimer::Reader::Reader(EpochReclaimer &reclaimer) : reclaimer(reclaimer), slot(-1) {
+    for (int i = 0; i < MAX_READERS and slot < 0; ++i) {
+        bool expected = false;
+        if (reclaimer.slots[i].taken.compare_exchange_strong(expected, true)) slot = i;
+    }
+    assert(slot >= 0);
+}
+
+EpochReclaimer::Reader::~Reader() {
+    unpin();
+    reclaimer.slots[slot].taken.store(false);
+}
+
+/**
+ * @brief Announces that the reader is about to load a published pointer, which stays valid until the next unpin
+ */
+void EpochReclaimer::Reader::pin() {
+    reclaimer.slots[slot].epoch.store(reclaimer.epoch.load());
+}
+
+void EpochReclaimer::Reader::unpin() {
+    reclaimer.slots[slot].epoch.store(IDLE);
+}
+
+/**
+ * @brief Frees everything still retired, no reader may be pinned any more
+ */
+EpochReclaimer::~EpochReclaimer() {
+    for (Retired &r: retired) r.free();
+}
+
+/**
+ * @brief Schedules free to run once no reader can reach what it frees, must be called after the replacement is
+ * published
+ */
+void EpochReclaimer::retire(std::function<void()> free) {
+    retired.push_back(Retired{epoch.load(), std::move(free)});
+}
+
+/**
+ * @brief Starts a new epoch and frees everything retired before the oldest epoch a reader is pinned in
+ */
+void EpochReclaimer::advance() {
+    epoch.fetch_add(1);
+    std::uint64_t oldest = IDLE;
+    for (Slot &slot: slots) oldest = std::min(oldest, slot.epoch.load());
+    std::size_t freed = 0;
+    while (freed < retired.size() and retired[freed].epoch < oldest) {
+        retired[freed].free();
+        freed++;
+    }
+    retired.erase(retired.begin(), retired.begin() + freed);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file EpochReclaimer.h
+ * @brief Epoch based reclamation for structures that one writer replaces while reader threads may still be using them.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_EPOCHRECLAIMER_H
+#define DYNAMICCONVEXHULL_EPOCHRECLAIMER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class EpochReclaimer {
+public:
+    static const int MAX_READERS = 64;
+
+    /**
+     * @brief A handle for one reader thread, holding one of the reader slots for its lifetime
+     */
+    class Reader {
+    public:
+        explicit Reader(EpochReclaimer &reclaimer);
+
+        Reader(const Reader &) = delete;
+
+        Reader &operator=(const Reader &) = delete;
+
+        ~Reader();
+
+        void pin();
+
+        void unpin();
+
+    private:
+        EpochReclaimer &reclaimer;
+        int slot;
+    };
+
+    EpochReclaimer() = default;
+
+    EpochReclaimer(const EpochReclaimer &) = delete;
+
+    EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    ~EpochReclaimer();
+
+    void retire(std::function<void()> free);
+
+    void advance();
+
+private:
+    // The epoch a reader pinned, or IDLE
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{IDLE};
+        std::atomic<bool> taken{false};
+    };
+
+    struct Retired {
+        std::uint64_t epoch;
+        std::function<void()> free;
+    };
+
+    static const std::uint64_t IDLE = UINT64_MAX;
+
+    std::atomic<std::uint64_t> epoch{0};
+    Slot slots[MAX_READERS];
+    std::vector<Retired> retired;
+};
+
+
+#endif //DYNAMICCONVEXHULL_EPOCHRECLAIMER_H
@@ -0,0 +1,244 @@
+/**
+ * @file HalfPlaneSet.cpp
+ * @date 10/19/26
+ * @details Every half-plane that is not vertical bounds y from above or below by a line, so the region is the set of
+ * points between the highest floor and the lowest ceiling, within the vertical bounds. By duality the lowest ceiling at
+ * x is the lower hull vertex of the ceilings extreme in direction (-x, -1) and the highest floor the upper hull vertex
+ * of the floors extreme in direction (x, 1). Consecutive hull vertices are lines that cross where the envelope breaks,
+ * so the breakpoints of both envelopes can be binary searched on the root hulls without listing them. The height of
+ * the region is concave in x, as is any linear objective along the ceiling or floor, so every query is a handful of
+ * such searches, O(log^2 h).
+ */
+
+#include "HalfPlaneSet.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using QNode = ConcatenableQueue::QNode;
+
+static const double INF = std::numeric_limits<double>::infinity();
+
+/**
+ * @brief The x coordinate where the line of n stops being on the envelope and the line of the next vertex takes over
+ * @details The breakpoints decrease along the lower hull of the ceilings and increase along the upper hull of the
+ * floors. A vertical edge joins two parallel lines of which only one is ever on the envelope, and the placeholder ends
+ * the chain, so both are given the breakpoint that keeps the order.
+ */
+static double breakpoint(const QNode *n, bool ceiling) {
+    const Angle &a = n->angle;
+    if (std::isinf(a.right.y)) return ceiling ? -INF : INF;
+    if (a.right.x == a.middle.x) return -INF;
+    return -(a.right.y - a.middle.y) / (a.right.x - a.middle.x);
+}
+
+// The dual point (m, k) of the line on the envelope just right of the finite coordinate x
+static Point lineRightOf(QNode *n, double x, bool ceiling) {
+    QNode *found = nullptr;
+    while (n != nullptr) {
+        double b = breakpoint(n, ceiling);
+        if (ceiling ? b <= x : b > x) {
+            found = n;
+            n = n->left;
+        } else {
+            n = n->right;
+        }
+    }
+    return found->angle.middle;
+}
+
+static double valueAt(const Point &line, double x) {
+    return line.x * x + line.y;
+}
+
+/**
+ * @brief Shrinks the range (lo, hi) until it holds no breakpoint of an envelope
+ * @param right Whether the target lies right of a breakpoint strictly inside the range
+ */
+template<class Right>
+static void narrow(QNode *n, bool ceiling, double &lo, double &hi, Right right) {
+    while (n != nullptr) {
+        double b = breakpoint(n, ceiling);
+        bool larger;
+        if (b <= lo) {
+            larger = true;
+        } else if (b >= hi) {
+            larger = false;
+        } else if (right(b)) {
+            lo = b;
+            larger = true;
+        } else {
+            hi = b;
+            larger = false;
+        }
+        n = larger == ceiling ? n->left : n->right;
+    }
+}
+
+// The slope of a function that is linear on the non empty range [lo, hi], given its slope just right of any x
+template<class Slope>
+static double pieceSlope(double lo, double hi, Slope slope) {
+    if (not std::isinf(lo)) return slope(lo);
+    if (not std::isinf(hi)) return slope(hi - std::max(1.0, std::abs(hi)));
+    return slope(0.0);
+}
+
+/**
+ * @brief The height of the region at x, the lowest ceiling minus the highest floor, for non empty ceilings and floors
+ * @details It is concave in x and the region is not empty where it is not negative.
+ */
+struct Gap {
+    QNode *ceilings;
+    QNode *floors;
+
+    double at(double x) const {
+        return valueAt(lineRightOf(ceilings, x, true), x) - valueAt(lineRightOf(floors, x, false), x);
+    }
+
+    double rightSlope(double x) const {
+        return lineRightOf(ceilings, x, true).x - lineRightOf(floors, x, false).x;
+    }
+
+    // Heights below this are within the rounding error of evaluating the envelopes at x and count as touching
+    double tolerance(double x) const {
+        double largest = std::max(std::abs(valueAt(lineRightOf(ceilings, x, true), x)),
+                                  std::abs(valueAt(lineRightOf(floors, x, false), x)));
+        return 64 * std::numeric_limits<double>::epsilon() * largest;
+    }
+};
+
+static Gap gapOf(LineEnvelope &ceilings, LineEnvelope &floors) {
+    return Gap{ceilings.tree.root->lower_hull->root, floors.tree.root->upper_hull->root};
+}
+
+/**
+ * @brief Adds the constraint a * x + b * y <= c
+ * @return false if the constraint is already in the set or is not a half-plane because a and b are both 0
+ * @details Constraints are identified by their boundary line and side, so scaled copies count as the same constraint.
+ */
+bool HalfPlaneSet::insert(HalfPlane h) {
+    if (h.b > 0) return ceilings.insert(-h.a / h.b, h.c / h.b);
+    if (h.b < 0) return floors.insert(-h.a / h.b, h.c / h.b);
+    if (h.a > 0) return rightBounds.insert(h.c / h.a).second;
+    if (h.a < 0) return leftBounds.insert(h.c / h.a).second;
+    return false;
+}
+
+/**
+ * @brief Removes the constraint a * x + b * y <= c
+ * @return false if the constraint is not in the set
+ */
+bool HalfPlaneSet::remove(HalfPlane h) {
+    if (h.b > 0) return ceilings.remove(-h.a / h.b, h.c / h.b);
+    if (h.b < 0) return floors.remove(-h.a / h.b, h.c / h.b);
+    if (h.a > 0) return rightBounds.erase(h.c / h.a) > 0;
+    if (h.a < 0) return leftBounds.erase(h.c / h.a) > 0;
+    return false;
+}
+
+/**
+ * @brief Finds where the region is tallest
+ * @param x Set to a finite x coordinate of a point in the region if there is one
+ * @return Whether the region is non empty, touching constraints up to rounding count as non empty
+ * @details The height only breaks at breakpoints of the two envelopes, so searching both for the sign of its slope
+ * leaves a range where it is linear and largest at one end. If it grows without bound, x steps twice as far along the
+ * range as needed for the height to be non negative, so that rounding cannot leave it just below 0.
+ */
+bool HalfPlaneSet::widest(double &x) {
+    double lo = leftBounds.empty() ? -INF : *leftBounds.rbegin();
+    double hi = rightBounds.empty() ? INF : *rightBounds.begin();
+    if (lo > hi) return false;
+    if (ceilings.empty() or floors.empty()) {
+        x = std::clamp(0.0, lo, hi);
+        return true;
+    }
+    Gap gap = gapOf(ceilings, floors);
+    auto rises = [&](double b) { return gap.rightSlope(b) > 0; };
+    narrow(gap.ceilings, true, lo, hi, rises);
+    narrow(gap.floors, false, lo, hi, rises);
+    double slope = lo == hi ? 0 : pieceSlope(lo, hi, [&](double t) { return gap.rightSlope(t); });
+    if (slope > 0) {
+        x = hi;
+        if (std::isinf(hi)) {
+            double start = std::isinf(lo) ? 0 : lo;
+            x = std::max(start, start - 2 * gap.at(start) / slope);
+        }
+    } else if (slope < 0) {
+        x = lo;
+        if (std::isinf(lo)) {
+            double start = std::isinf(hi) ? 0 : hi;
+            x = std::min(start, start - 2 * gap.at(start) / slope);
+        }
+    } else {
+        x = std::isinf(lo) ? (std::isinf(hi) ? 0 : hi) : lo;
+    }
+    return gap.at(x) >= -gap.tolerance(x);
+}
+
+/**
+ * @brief Determines whether some point satisfies every constraint, O(log^2 h)
+ */
+bool HalfPlaneSet::isFeasible() {
+    double x;
+    return widest(x);
+}
+
+/**
+ * @brief Finds a point of the region maximizing the dot product with objective
+ * @return The status and, unless the region is empty or the objective unbounded on it, a maximizing point
+ * @details For a fixed x the best point lies on the ceiling when the objective points up and on the floor when it
+ * points down, which leaves a concave function of x. Its maximum over the vertical bounds is searched on the one
+ * envelope it depends on. If that point is outside the region the optimum is where the region ends in its direction,
+ * found by searching both envelopes for the sign of the height between the tallest point and it. O(log^2 h).
+ */
+HalfPlaneSet::Optimum HalfPlaneSet::optimize(Direction objective) {
+    Optimum optimum;
+    double tallest;
+    if (not widest(tallest)) return optimum;
+    optimum.status = Unbounded;
+    if ((objective.y > 0 and ceilings.empty()) or (objective.y < 0 and floors.empty())) return optimum;
+    double lo = leftBounds.empty() ? -INF : *leftBounds.rbegin();
+    double hi = rightBounds.empty() ? INF : *rightBounds.begin();
+    double x;
+    if (objective.y == 0) {
+        x = objective.x > 0 ? hi : objective.x < 0 ? lo : tallest;
+    } else {
+        bool ceiling = objective.y > 0;
+        QNode *chain = ceiling ? ceilings.tree.root->lower_hull->root : floors.tree.root->upper_hull->root;
+        auto slope = [&](double t) { return objective.x + objective.y * lineRightOf(chain, t, ceiling).x; };
+        narrow(chain, ceiling, lo, hi, [&](double b) { return slope(b) > 0; });
+        double s = lo == hi ? 0 : pieceSlope(lo, hi, slope);
+        x = s > 0 ? hi : s < 0 ? lo : std::isinf(lo) ? (std::isinf(hi) ? tallest : hi) : lo;
+    }
+    if (ceilings.empty() or floors.empty()) {
+        if (std::isinf(x)) return optimum;
+    } else {
+        Gap gap = gapOf(ceilings, floors);
+        if (std::isinf(x) or gap.at(x) < -gap.tolerance(x)) {
+            // The region ends between the tallest point, where the height is not negative, and x
+            bool rightwards = x > tallest;
+            lo = std::min(tallest, x);
+            hi = std::max(tallest, x);
+            auto right = [&](double b) { return (gap.at(b) >= 0) == rightwards; };
+            narrow(gap.ceilings, true, lo, hi, right);
+            narrow(gap.floors, false, lo, hi, right);
+            double s = pieceSlope(lo, hi, [&](double t) { return gap.rightSlope(t); });
+            if (rightwards) {
+                if (s >= 0 and std::isinf(hi)) return optimum;
+                x = s >= 0 ? hi : std::clamp(lo - gap.at(lo) / s, lo, hi);
+            } else {
+                if (s <= 0 and std::isinf(lo)) return optimum;
+                x = s <= 0 ? lo : std::clamp(hi - gap.at(hi) / s, lo, hi);
+            }
+        }
+    }
+    double y = 0;
+    if (objective.y < 0 or (objective.y == 0 and not floors.empty())) {
+        y = valueAt(lineRightOf(floors.tree.root->upper_hull->root, x, false), x);
+    } else if (not ceilings.empty()) {
+        y = valueAt(lineRightOf(ceilings.tree.root->lower_hull->root, x, true), x);
+    }
+    optimum.status = Optimal;
+    optimum.point = Point(x, y);
+    return optimum;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file HalfPlaneSet.h
+ * @brief A dynamic intersection of half-planes a * x + b * y <= c supporting feasibility and linear objective queries.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_HALFPLANESET_H
+#define DYNAMICCONVEXHULL_HALFPLANESET_H
+
+#include <set>
+#include "LineEnvelope.h"
+
+// The half-plane a * x + b * y <= c
+struct HalfPlane {
+    double a;
+    double b;
+    double c;
+};
+
+class HalfPlaneSet {
+public:
+    enum Status {Infeasible, Optimal, Unbounded};
+
+    struct Optimum {
+        Status status = Infeasible;
+        Point point;
+    };
+
+    // Half-planes below a line y <= m * x + k, the region lies under the lower envelope of these lines
+    LineEnvelope ceilings;
+    // Half-planes above a line y >= m * x + k, the region lies over the upper envelope of these lines
+    LineEnvelope floors;
+    // Vertical half-planes x >= v and x <= v
+    std::set<double> leftBounds;
+    std::set<double> rightBounds;
+
+    bool insert(HalfPlane h);
+
+    bool remove(HalfPlane h);
+
+    bool isFeasible();
+
+    Optimum optimize(Direction objective);
+
+private:
+    bool widest(double &x);
+};
+
+
+#endif //DYNAMICCONVEXHULL_HALFPLANESET_H
@@ -0,0 +1,352 @@
+/**
+ * @file HullMap.h
+ * @brief Many small hulls, one per key, updated concurrently from any number of threads.
+ * @date 10/19/26
+ * @details A TTree costs two hull queues per node and a few hundred bytes even for a handful of points, which
+ * dominates when most keys only ever hold a few. Such keys keep their points in a fixed size block of an arena shared
+ * by all keys of a shard, with the hull vertices in order at the front of the block. The block is only rearranged when
+ * an update changes the hull, which for up to SMALL points is cheaper than maintaining a tree. A key is promoted to
+ * its own TTree once it outgrows its block and demoted again once it shrinks to half of it.
+ * Keys are spread over shards by hash and every shard has its own lock, so updates of keys in different shards run
+ * in parallel.
+ */
+
+#ifndef DYNAMICCONVEXHULL_HULLMAP_H
+#define DYNAMICCONVEXHULL_HULLMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "TTree.h"
+
+template<class Key, class Hash = std::hash<Key>>
+class HullMap {
+public:
+    // The most points a key keeps in the arena
+    static const int SMALL = 16;
+
+    // Bytes used by the map, estimated from the sizes of its containers and nodes
+    struct MemoryUsage {
+        std::size_t hulls = 0;
+        std::size_t small = 0;
+        std::size_t large = 0;
+        std::size_t bytes = 0;
+        std::size_t smallBytes = 0;
+        std::size_t largeBytes = 0;
+    };
+
+    // The points of one key, in block of the arena of its shard while small and in tree once promoted. The first hull
+    // points of a block are its hull vertices in the same order as TTree::getHull.
+    struct Entry {
+        int block = -1;
+        int count = 0;
+        int hull = 0;
+        std::unique_ptr<TTree> tree;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, Entry, Hash> entries;
+        // Blocks of SMALL points, unused blocks are listed in free
+        std::vector<Point> arena;
+        std::vector<int> free;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    explicit HullMap(std::size_t shardCount = 0);
+
+    bool insert(const Key &key, Point p);
+
+    bool remove(const Key &key, Point p);
+
+    bool contains(const Key &key, Point p);
+
+    std::vector<Point> getHull(const Key &key);
+
+    std::size_t size();
+
+    MemoryUsage memoryUsage();
+
+private:
+    Shard &shardOf(const Key &key);
+
+    static Point *points(Shard &shard, const Entry &entry);
+
+    static int allocate(Shard &shard);
+
+    static void promote(Shard &shard, Entry &entry);
+
+    static void demote(Shard &shard, Entry &entry);
+
+    static void collect(const TTree::TNode *n, std::vector<Point> &out);
+
+    static int arrange(Point *begin, int count);
+
+    static bool hullContains(const Point *hull, int size, const Point &p);
+
+    static std::size_t treeBytes(const TTree::TNode *n);
+};
+
+/**
+ * @param shardCount The number of independently locked shards, by default 8 per hardware thread
+ */
+template<class Key, class Hash>
+HullMap<Key, Hash>::HullMap(std::size_t shardCount) {
+    if (shardCount == 0) shardCount = 8 * std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < shardCount; i++) shards.push_back(std::make_unique<Shard>());
+}
+
+template<class Key, class Hash>
+typename HullMap<Key, Hash>::Shard &HullMap<Key, Hash>::shardOf(const Key &key) {
+    // The hash is mixed since the map of the shard uses the same one
+    std::size_t h = Hash()(key) * 0x9E3779B97F4A7C15ULL;
+    return *shards[(h >> 32) % shards.size()];
+}
+
+template<class Key, class Hash>
+Point *HullMap<Key, Hash>::points(Shard &shard, const Entry &entry) {
+    return shard.arena.data() + static_cast<std::size_t>(entry.block) * SMALL;
+}
+
+template<class Key, class Hash>
+int HullMap<Key, Hash>::allocate(Shard &shard) {
+    if (not shard.free.empty()) {
+        int block = shard.free.back();
+        shard.free.pop_back();
+        return block;
+    }
+    shard.arena.resize(shard.arena.size() + SMALL);
+    return static_cast<int>(shard.arena.size() / SMALL) - 1;
+}
+
+// Moves the points of a full block into a new tree and releases the block
+template<class Key, class Hash>
+void HullMap<Key, Hash>::promote(Shard &shard, Entry &entry) {
+    entry.tree = std::make_unique<TTree>();
+    Point *p = points(shard, entry);
+    for (int i = 0; i < entry.count; i++) entry.tree->insert(p[i]);
+    shard.free.push_back(entry.block);
+    entry.block = -1;
+    entry.hull = 0;
+}
+
+template<class Key, class Hash>
+void HullMap<Key, Hash>::demote(Shard &shard, Entry &entry) {
+    std::vector<Point> all;
+    collect(entry.tree->root, all);
+    entry.tree.reset();
+    entry.block = allocate(shard);
+    std::copy(all.begin(), all.end(), points(shard, entry));
+    entry.hull = arrange(points(shard, entry), entry.count);
+}
+
+template<class Key, class Hash>
+void HullMap<Key, Hash>::collect(const TTree::TNode *n, std::vector<Point> &out) {
+    if (n == nullptr) return;
+    if (n->isLeaf) {
+        out.push_back(n->point);
+        return;
+    }
+    collect(n->left, out);
+    collect(n->right, out);
+}
+
+/**
+ * @brief Moves the hull vertices of a block to its front in the same order as TTree::getHull, by the monotone chain
+ * algorithm
+ * @return The number of hull vertices
+ */
+template<class Key, class Hash>
+int HullMap<Key, Hash>::arrange(Point *begin, int count) {
+    Point sorted[SMALL];
+    std::copy(begin, begin + count, sorted);
+    std::sort(sorted, sorted + count);
+    if (count <= 2) {
+        std::copy(sorted, sorted + count, begin);
+        return count;
+    }
+    Point hull[2 * SMALL];
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+        while (size >= 2 and Angle::turn(hull[size - 2], hull[size - 1], sorted[i]) <= 0) size--;
+        hull[size++] = sorted[i];
+    }
+    int lower = size;
+    for (int i = count - 2; i >= 0; i--) {
+        while (size > lower and Angle::turn(hull[size - 2], hull[size - 1], sorted[i]) <= 0) size--;
+        hull[size++] = sorted[i];
+    }
+    size--;
+    Point *rest = std::copy(hull, hull + size, begin);
+    for (int i = 0; i < count; i++) {
+        if (std::find(hull, hull + size, sorted[i]) == hull + size) *rest++ = sorted[i];
+    }
+    return size;
+}
+
+// Whether p lies inside or on the boundary of the hull with the given vertices in counter clockwise order
+template<class Key, class Hash>
+bool HullMap<Key, Hash>::hullContains(const Point *hull, int size, const Point &p) {
+    if (size <= 2) {
+        Point a = hull[0];
+        Point b = hull[size - 1];
+        return Angle::turn(a, b, p) == 0 and std::min(a, b) <= p and p <= std::max(a, b);
+    }
+    for (int i = 0; i < size; i++) {
+        if (Angle::turn(hull[i], hull[(i + 1) % size], p) < 0) return false;
+    }
+    return true;
+}
+
+// Bytes of the nodes of a tree and of the hull queue nodes they hold
+template<class Key, class Hash>
+std::size_t HullMap<Key, Hash>::treeBytes(const TTree::TNode *n) {
+    if (n == nullptr) return 0;
+    std::size_t queues = static_cast<std::size_t>(n->lower_hull->size() + n->upper_hull->size());
+    return sizeof(TTree::TNode) + 2 * sizeof(ConcatenableQueue) + queues * sizeof(ConcatenableQueue::QNode) +
+           treeBytes(n->left) + treeBytes(n->right);
+}
+
+/**
+ * @brief Adds p to the points of key, creating the key if needed
+ * @return false if p already was one of them
+ */
+template<class Key, class Hash>
+bool HullMap<Key, Hash>::insert(const Key &key, Point p) {
+    Shard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Entry &entry = shard.entries[key];
+    if (entry.tree) {
+        if (not entry.tree->insert(p)) return false;
+        entry.count++;
+        return true;
+    }
+    if (entry.block < 0) entry.block = allocate(shard);
+    Point *begin = points(shard, entry);
+    if (std::find(begin, begin + entry.count, p) != begin + entry.count) return false;
+    if (entry.count == SMALL) {
+        promote(shard, entry);
+        entry.tree->insert(p);
+        entry.count++;
+        return true;
+    }
+    // A point within the hull joins the points behind it. Otherwise those stay within the hull, so only its vertices and
+    // p are arranged again.
+    begin[entry.count] = p;
+    entry.count++;
+    if (entry.hull > 0 and hullContains(begin, entry.hull, p)) return true;
+    std::swap(begin[entry.hull], begin[entry.count - 1]);
+    entry.hull = arrange(begin, entry.hull + 1);
+    return true;
+}
+
+/**
+ * @brief Removes p from the points of key, dropping the key with its last point
+ * @return false if p was not one of them
+ */
+template<class Key, class Hash>
+bool HullMap<Key, Hash>::remove(const Key &key, Point p) {
+    Shard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) return false;
+    Entry &entry = it->second;
+    if (entry.tree) {
+        if (not entry.tree->remove(p)) return false;
+        entry.count--;
+        if (entry.count <= SMALL / 2) demote(shard, entry);
+        return true;
+    }
+    Point *begin = points(shard, entry);
+    Point *found = std::find(begin, begin + entry.count, p);
+    if (found == begin + entry.count) return false;
+    bool onHull = found < begin + entry.hull;
+    *found = begin[entry.count - 1];
+    entry.count--;
+    if (entry.count == 0) {
+        shard.free.push_back(entry.block);
+        shard.entries.erase(it);
+    } else if (onHull) {
+        entry.hull = arrange(begin, entry.count);
+    }
+    return true;
+}
+
+/**
+ * @brief Determines whether p lies inside or on the boundary of the hull of key, false for unknown keys
+ */
+template<class Key, class Hash>
+bool HullMap<Key, Hash>::contains(const Key &key, Point p) {
+    Shard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) return false;
+    Entry &entry = it->second;
+    if (entry.tree) return entry.tree->contains(p);
+    return hullContains(points(shard, entry), entry.hull, p);
+}
+
+/**
+ * @brief The hull vertices of key in the same order as TTree::getHull, empty for unknown keys
+ */
+template<class Key, class Hash>
+std::vector<Point> HullMap<Key, Hash>::getHull(const Key &key) {
+    Shard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) return {};
+    Entry &entry = it->second;
+    if (entry.tree) return entry.tree->getHull();
+    return std::vector<Point>(points(shard, entry), points(shard, entry) + entry.hull);
+}
+
+// The number of keys with at least one point
+template<class Key, class Hash>
+std::size_t HullMap<Key, Hash>::size() {
+    std::size_t count = 0;
+    for (auto &shard: shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        count += shard->entries.size();
+    }
+    return count;
+}
+
+/**
+ * @brief Adds up the memory of every shard, O(n) since the trees of large hulls are walked
+ * @details Small hulls are charged their map node and an equal share of the arena, large hulls their map node and
+ * tree. The bucket arrays are only counted in the total.
+ */
+template<class Key, class Hash>
+typename HullMap<Key, Hash>::MemoryUsage HullMap<Key, Hash>::memoryUsage() {
+    MemoryUsage usage;
+    // A node of an unordered map holds the next pointer and the cached hash besides the pair
+    std::size_t node = sizeof(std::pair<const Key, Entry>) + 2 * sizeof(void *);
+    for (auto &shard: shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        std::size_t small = 0;
+        for (auto &[key, entry]: shard->entries) {
+            if (entry.tree) {
+                usage.large++;
+                usage.largeBytes += node + sizeof(TTree) + treeBytes(entry.tree->root);
+            } else {
+                small++;
+                usage.smallBytes += node;
+            }
+        }
+        usage.small += small;
+        usage.smallBytes += shard->arena.capacity() * sizeof(Point) + shard->free.capacity() * sizeof(int);
+        usage.bytes += sizeof(Shard) + shard->entries.bucket_count() * sizeof(void *);
+    }
+    usage.hulls = usage.small + usage.large;
+    usage.bytes += usage.smallBytes + usage.largeBytes;
+    return usage;
+}
+
+
+#endif //DYNAMICCONVEXHULL_HULLMAP_H
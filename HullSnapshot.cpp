@@ -0,0 +1,304 @@
+/**
+ * @file HullSnapshot.cpp
+ * @date 10/19/26
+ * @details Every query finds the lower and upper hull edges spanning its x coordinate and performs one orientation test
+ * against each with Angle::turn. The binary search is branch free so that its sequence of steps only depends on the
+ * size of the hull, which lets the AVX2 kernel run four queries in lock step. Small hulls are searched by counting
+ * vertices instead and edges are packed so that each lane needs a single load. The kernel applies the error bound of
+ * Angle::turn to every lane and hands lanes it cannot decide to the scalar test. Builds without AVX2 use the scalar
+ * loop.
+ */
+
+#include "HullSnapshot.h"
+#include <algorithm>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+HullSnapshot::HullSnapshot(TTree &tree) {
+    update(tree);
+}
+
+/**
+ * @brief Copies the current root hull of the tree, reusing the existing buffers
+ * @details The chains are read straight from the hull trees, so nothing is allocated unless the hull has grown past
+ * the capacity of the buffers.
+ */
+void HullSnapshot::update(TTree &tree) {
+    lowerX.clear();
+    lowerY.clear();
+    upperX.clear();
+    upperY.clear();
+    lowerEdges.clear();
+    upperEdges.clear();
+    if (tree.root == nullptr) return;
+    copyChain(tree.root->lower_hull->root, lowerX, lowerY);
+    copyChain(tree.root->upper_hull->root, upperX, upperY);
+    // A lower hull can end and an upper hull start with a vertical edge, which every query at its x coordinate would be
+    // collinear with. Only the bottom of the first and the top of the second bound the hull, so the edges are dropped.
+    while (lowerX.size() > 1 and lowerX[lowerX.size() - 2] == lowerX.back()) {
+        lowerX.pop_back();
+        lowerY.pop_back();
+    }
+    std::size_t first = 0;
+    while (first + 1 < upperX.size() and upperX[first + 1] == upperX[first]) first++;
+    upperX.erase(upperX.begin(), upperX.begin() + first);
+    upperY.erase(upperY.begin(), upperY.begin() + first);
+    edgeTable(lowerX, lowerY, lowerEdges);
+    edgeTable(upperX, upperY, upperEdges);
+}
+
+// Appends the vertices of a chain from left to right, walking the tree in place
+void HullSnapshot::copyChain(ConcatenableQueue::QNode *root, std::vector<double> &xs, std::vector<double> &ys) {
+    for (auto it = ConcatenableQueue::Iterator::first(root); it.valid(); it.next()) {
+        xs.push_back(it.node()->angle.middle.x);
+        ys.push_back(it.node()->angle.middle.y);
+    }
+}
+
+bool HullSnapshot::empty() const {
+    return lowerX.empty();
+}
+
+/**
+ * @brief Packs the edges of a chain as {x, y, dx, dy} so that one load fetches everything an orientation test needs
+ * @param edges Cleared and refilled, keeping its capacity
+ */
+void HullSnapshot::edgeTable(const std::vector<double> &xs, const std::vector<double> &ys, std::vector<double> &edges) {
+    edges.clear();
+    for (std::size_t i = 0; i + 1 < xs.size(); ++i) {
+        edges.push_back(xs[i]);
+        edges.push_back(ys[i]);
+        edges.push_back(xs[i + 1] - xs[i]);
+        edges.push_back(ys[i + 1] - ys[i]);
+    }
+}
+
+/**
+ * @brief Finds the edge of a chain spanning x
+ * @param xs The x coordinates of a chain with at least two vertices
+ * @return The index i of the edge from vertex i to vertex i + 1, clamped to the first and last edge
+ */
+std::size_t HullSnapshot::findEdge(const std::vector<double> &xs, double x) {
+    std::size_t base = 0;
+    std::size_t len = xs.size() - 1;
+    while (len > 1) {
+        std::size_t half = len / 2;
+        base += (xs[base + half] <= x) ? half : 0;
+        len -= half;
+    }
+    return base;
+}
+
+/**
+ * @brief Twice the signed area of the triangle from vertex i to vertex i + 1 of a chain to (x, y), positive for a left
+ * turn
+ * @param certain Whether the sign is certain by the error bound of Angle::turn
+ */
+static inline double orientation(const std::vector<double> &xs, const std::vector<double> &ys, std::size_t i, double x,
+                                 double y, bool &certain) {
+    double left = (xs[i + 1] - xs[i]) * (y - ys[i]);
+    double right = (ys[i + 1] - ys[i]) * (x - xs[i]);
+    double det = left - right;
+    double bound = Angle::TURN_ERROR_BOUND * (std::abs(left) + std::abs(right));
+    certain = std::abs(det) > bound or bound == 0;
+    return det;
+}
+
+// The sign of the turn from vertex i to vertex i + 1 of a chain to (x, y), computed exactly
+static inline int turn(const std::vector<double> &xs, const std::vector<double> &ys, std::size_t i, double x, double y) {
+    bool certain;
+    double det = orientation(xs, ys, i, x, y, certain);
+    if (certain) return (det > 0) - (det < 0);
+    return Angle::turn(Point(xs[i], ys[i]), Point(xs[i + 1], ys[i + 1]), Point(x, y));
+}
+
+bool HullSnapshot::contains(double x, double y) const {
+    if (empty() or x < lowerX.front() or x > lowerX.back()) return false;
+    // Vertical chains of a single vertex compare y, all others are decided exactly when the sign is uncertain
+    std::size_t i = lowerX.size() == 1 ? 0 : findEdge(lowerX, x);
+    std::size_t j = upperX.size() == 1 ? 0 : findEdge(upperX, x);
+    bool lowerCertain = true;
+    bool upperCertain = true;
+    bool aboveLower = lowerX.size() == 1 ? y >= lowerY[0] : orientation(lowerX, lowerY, i, x, y, lowerCertain) >= 0;
+    bool belowUpper = upperX.size() == 1 ? y <= upperY[0] : orientation(upperX, upperY, j, x, y, upperCertain) <= 0;
+    if (not lowerCertain) aboveLower = turn(lowerX, lowerY, i, x, y) >= 0;
+    if (not upperCertain) belowUpper = turn(upperX, upperY, j, x, y) <= 0;
+    return aboveLower and belowUpper;
+}
+
+/**
+ * @brief Classifies n points given as separate x and y arrays, writing 1 to inside[i] if point i is inside or on the
+ * boundary of the hull and 0 otherwise.
+ * @details Sorted input is swept against the hull in a single merge pass, otherwise every point is binary searched,
+ * using the AVX2 kernel when it is available.
+ */
+void HullSnapshot::classify(const double *x, const double *y, std::size_t n, std::uint8_t *inside) const {
+    if (std::is_sorted(x, x + n)) {
+        classifySorted(x, y, n, inside);
+        return;
+    }
+#ifdef __AVX2__
+    classifyAVX2(x, y, n, inside);
+#else
+    classifyScalar(x, y, n, inside);
+#endif
+}
+
+void HullSnapshot::classifyScalar(const double *x, const double *y, std::size_t n, std::uint8_t *inside) const {
+    for (std::size_t i = 0; i < n; ++i) {
+        inside[i] = contains(x[i], y[i]);
+    }
+}
+
+/**
+ * @brief Classifies points sorted by x coordinate, the edge indices only ever move right so the whole batch costs
+ * O(n + h)
+ */
+void HullSnapshot::classifySorted(const double *x, const double *y, std::size_t n, std::uint8_t *inside) const {
+    if (lowerX.size() < 2 or upperX.size() < 2) {
+        classifyScalar(x, y, n, inside);
+        return;
+    }
+    std::size_t i = 0;
+    std::size_t j = 0;
+    std::size_t lastLower = lowerX.size() - 2;
+    std::size_t lastUpper = upperX.size() - 2;
+    for (std::size_t k = 0; k < n; ++k) {
+        double qx = x[k];
+        double qy = y[k];
+        if (qx < lowerX.front() or qx > lowerX.back()) {
+            inside[k] = 0;
+            continue;
+        }
+        while (i < lastLower and lowerX[i + 1] <= qx) i++;
+        while (j < lastUpper and upperX[j + 1] <= qx) j++;
+        bool lowerCertain;
+        bool upperCertain;
+        double lower = orientation(lowerX, lowerY, i, qx, qy, lowerCertain);
+        double upper = orientation(upperX, upperY, j, qx, qy, upperCertain);
+        inside[k] = lowerCertain and upperCertain ? lower >= 0 and upper <= 0 : contains(qx, qy);
+    }
+}
+
+/**
+ * @brief Finds a hull vertex maximizing the dot product with d, O(log h)
+ * @details Like TTree::extreme, directions pointing up are maximized on the upper chain and all others on the lower
+ * chain. The dot product of d with the edges, equivalently the cross product of the edge normals (dy, -dx) with d,
+ * changes sign once along the chain, at the maximizing vertex.
+ */
+std::optional<Point> HullSnapshot::extreme(Direction d) const {
+    if (empty()) return std::nullopt;
+    bool upper = d.y > 0;
+    const std::vector<double> &xs = upper ? upperX : lowerX;
+    const std::vector<double> &ys = upper ? upperY : lowerY;
+    const std::vector<double> &edges = upper ? upperEdges : lowerEdges;
+    std::size_t lo = 0;
+    std::size_t hi = xs.size() - 1;
+    while (lo < hi) {
+        std::size_t mid = (lo + hi) / 2;
+        if (d.x * edges[4 * mid + 2] + d.y * edges[4 * mid + 3] > 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return Point(xs[lo], ys[lo]);
+}
+
+#ifdef __AVX2__
+
+// Small chains are searched by counting the vertices left of each query, which needs no gathers
+static const std::size_t LINEAR_SEARCH_LIMIT = 32;
+
+// Finds the edge spanning each of four queries, mirrors HullSnapshot::findEdge
+static inline __m256i findEdges(const double *xs, std::size_t size, __m256d qx) {
+    __m256i base = _mm256_setzero_si256();
+    if (size <= LINEAR_SEARCH_LIMIT) {
+        for (std::size_t i = 1; i + 1 < size; ++i) {
+            // Comparison masks are all ones, so subtracting them counts the vertices at or left of qx
+            __m256d isLeft = _mm256_cmp_pd(_mm256_set1_pd(xs[i]), qx, _CMP_LE_OQ);
+            base = _mm256_sub_epi64(base, _mm256_castpd_si256(isLeft));
+        }
+        return base;
+    }
+    std::size_t len = size - 1;
+    while (len > 1) {
+        std::size_t half = len / 2;
+        __m256i probe = _mm256_add_epi64(base, _mm256_set1_epi64x((long long) half));
+        __m256d probeX = _mm256_i64gather_pd(xs, probe, 8);
+        __m256i goRight = _mm256_castpd_si256(_mm256_cmp_pd(probeX, qx, _CMP_LE_OQ));
+        base = _mm256_add_epi64(base, _mm256_and_si256(goRight, _mm256_set1_epi64x((long long) half)));
+        len -= half;
+    }
+    return base;
+}
+
+/**
+ * @brief Loads the four edges {x, y, dx, dy} selected by edge and transposes them into one register per field
+ * @param certain Set in the lanes whose sign is certain, by the error bound of Angle::turn, which allows for the
+ * rounded differences dx and dy of the edge table
+ */
+static inline __m256d orientations(const double *edges, __m256i edge, __m256d qx, __m256d qy, __m256d &certain) {
+    alignas(32) long long index[4];
+    _mm256_store_si256((__m256i *) index, edge);
+    __m256d e0 = _mm256_loadu_pd(edges + 4 * index[0]);
+    __m256d e1 = _mm256_loadu_pd(edges + 4 * index[1]);
+    __m256d e2 = _mm256_loadu_pd(edges + 4 * index[2]);
+    __m256d e3 = _mm256_loadu_pd(edges + 4 * index[3]);
+    __m256d t0 = _mm256_unpacklo_pd(e0, e1); // x0 x1 dx0 dx1
+    __m256d t1 = _mm256_unpackhi_pd(e0, e1); // y0 y1 dy0 dy1
+    __m256d t2 = _mm256_unpacklo_pd(e2, e3);
+    __m256d t3 = _mm256_unpackhi_pd(e2, e3);
+    __m256d ax = _mm256_permute2f128_pd(t0, t2, 0x20);
+    __m256d ay = _mm256_permute2f128_pd(t1, t3, 0x20);
+    __m256d dx = _mm256_permute2f128_pd(t0, t2, 0x31);
+    __m256d dy = _mm256_permute2f128_pd(t1, t3, 0x31);
+    __m256d lhs = _mm256_mul_pd(dx, _mm256_sub_pd(qy, ay));
+    __m256d rhs = _mm256_mul_pd(dy, _mm256_sub_pd(qx, ax));
+    __m256d det = _mm256_sub_pd(lhs, rhs);
+    const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffff));
+    __m256d bound = _mm256_mul_pd(_mm256_set1_pd(Angle::TURN_ERROR_BOUND),
+                                  _mm256_add_pd(_mm256_and_pd(lhs, absMask), _mm256_and_pd(rhs, absMask)));
+    certain = _mm256_or_pd(_mm256_cmp_pd(_mm256_and_pd(det, absMask), bound, _CMP_GT_OQ),
+                           _mm256_cmp_pd(bound, _mm256_setzero_pd(), _CMP_EQ_OQ));
+    return det;
+}
+
+void HullSnapshot::classifyAVX2(const double *x, const double *y, std::size_t n, std::uint8_t *inside) const {
+    if (lowerX.size() < 2 or upperX.size() < 2) {
+        classifyScalar(x, y, n, inside);
+        return;
+    }
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d minX = _mm256_set1_pd(lowerX.front());
+    const __m256d maxX = _mm256_set1_pd(lowerX.back());
+    std::size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m256d qx = _mm256_loadu_pd(x + k);
+        __m256d qy = _mm256_loadu_pd(y + k);
+        __m256d inRange = _mm256_and_pd(_mm256_cmp_pd(qx, minX, _CMP_GE_OQ), _mm256_cmp_pd(qx, maxX, _CMP_LE_OQ));
+        __m256i lowerEdge = findEdges(lowerX.data(), lowerX.size(), qx);
+        __m256i upperEdge = findEdges(upperX.data(), upperX.size(), qx);
+        __m256d lowerCertain;
+        __m256d upperCertain;
+        __m256d aboveLower = _mm256_cmp_pd(orientations(lowerEdges.data(), lowerEdge, qx, qy, lowerCertain), zero,
+                                           _CMP_GE_OQ);
+        __m256d belowUpper = _mm256_cmp_pd(orientations(upperEdges.data(), upperEdge, qx, qy, upperCertain), zero,
+                                           _CMP_LE_OQ);
+        int mask = _mm256_movemask_pd(_mm256_and_pd(inRange, _mm256_and_pd(aboveLower, belowUpper)));
+        int uncertain = _mm256_movemask_pd(_mm256_andnot_pd(_mm256_and_pd(lowerCertain, upperCertain), inRange));
+        inside[k] = mask & 1;
+        inside[k + 1] = (mask >> 1) & 1;
+        inside[k + 2] = (mask >> 2) & 1;
+        inside[k + 3] = (mask >> 3) & 1;
+        if (uncertain != 0) {
+            for (int l = 0; l < 4; ++l) {
+                if ((uncertain >> l) & 1) inside[k + l] = contains(x[k + l], y[k + l]);
+            }
+        }
+    }
+    classifyScalar(x + k, y + k, n - k, inside + k);
+}
+
+#endif
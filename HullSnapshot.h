@@ -0,0 +1,58 @@
+/**
+ * @file HullSnapshot.h
+ * @brief A flat copy of the root hull of a TTree laid out for batched point-in-hull classification.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_HULLSNAPSHOT_H
+#define DYNAMICCONVEXHULL_HULLSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "TTree.h"
+
+class HullSnapshot {
+public:
+    // Lower and upper hull vertices from left to right, stored as structure of arrays
+    std::vector<double> lowerX;
+    std::vector<double> lowerY;
+    std::vector<double> upperX;
+    std::vector<double> upperY;
+    // Edges of each chain packed as {x, y, dx, dy}
+    std::vector<double> lowerEdges;
+    std::vector<double> upperEdges;
+
+    HullSnapshot() = default;
+
+    explicit HullSnapshot(TTree &tree);
+
+    void update(TTree &tree);
+
+    bool empty() const;
+
+    bool contains(double x, double y) const;
+
+    void classify(const double *x, const double *y, std::size_t n, std::uint8_t *inside) const;
+
+    void classifyScalar(const double *x, const double *y, std::size_t n, std::uint8_t *inside) const;
+
+    void classifySorted(const double *x, const double *y, std::size_t n, std::uint8_t *inside) const;
+
+    std::optional<Point> extreme(Direction d) const;
+
+private:
+    static std::size_t findEdge(const std::vector<double> &xs, double x);
+
+    static void edgeTable(const std::vector<double> &xs, const std::vector<double> &ys, std::vector<double> &edges);
+
+    static void copyChain(ConcatenableQueue::QNode *root, std::vector<double> &xs, std::vector<double> &ys);
+
+#ifdef __AVX2__
+    void classifyAVX2(const double *x, const double *y, std::size_t n, std::uint8_t *inside) const;
+#endif
+};
+
+
+#endif //DYNAMICCONVEXHULL_HULLSNAPSHOT_H
@@ -0,0 +1,37 @@
+/**
+ * @file Line.h
+ * @brief Lines, segments and the hull edges they cross.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_LINE_H
+#define DYNAMICCONVEXHULL_LINE_H
+
+#include "Point.h"
+
+// The infinite line through a and b
+struct Line {
+    Point a;
+    Point b;
+};
+
+// The closed segment from a to b
+struct Segment {
+    Point a;
+    Point b;
+};
+
+// A point where a line crosses the hull boundary and the hull edge it crosses
+struct Crossing {
+    Point point;
+    Point edgeStart;
+    Point edgeEnd;
+};
+
+// The at most two points where a line or segment crosses the hull boundary
+struct HullCrossings {
+    int count = 0;
+    Crossing crossings[2];
+};
+
+#endif //DYNAMICCONVEXHULL_LINE_H
@@ -0,0 +1,82 @@
+/**
+ * @file LineEnvelope.cpp
+ * @date 10/19/26
+ * @details The value of the line (m, b) at x is the dot product of its dual point with (x, 1). The maximum over all
+ * lines is therefore attained at the hull vertex extreme in direction (x, 1), which lies on the upper hull, and the
+ * minimum at the vertex extreme in direction (-x, -1) on the lower hull. Lines that never appear on an envelope are
+ * exactly the dual points inside the hull, so inserting and removing lines costs the same as for points.
+ */
+
+#include "LineEnvelope.h"
+
+// The smallest and largest intercept of a slope
+static std::set<double> extremes(const std::set<double> &lines) {
+    if (lines.empty()) return {};
+    return {*lines.begin(), *lines.rbegin()};
+}
+
+/**
+ * @brief Adds the line y = slope * x + intercept
+ * @return false if the same line is already in the set
+ */
+bool LineEnvelope::insert(double slope, double intercept) {
+    std::set<double> &lines = intercepts[slope];
+    std::set<double> before = extremes(lines);
+    if (not lines.insert(intercept).second) return false;
+    replaceExtremes(slope, before, extremes(lines));
+    return true;
+}
+
+/**
+ * @brief Removes the line y = slope * x + intercept
+ * @return false if the line is not in the set
+ */
+bool LineEnvelope::remove(double slope, double intercept) {
+    auto found = intercepts.find(slope);
+    if (found == intercepts.end() or found->second.count(intercept) == 0) return false;
+    std::set<double> &lines = found->second;
+    std::set<double> before = extremes(lines);
+    lines.erase(intercept);
+    replaceExtremes(slope, before, extremes(lines));
+    if (lines.empty()) intercepts.erase(found);
+    return true;
+}
+
+/**
+ * @brief Swaps the lines of one slope in the tree from the old to the new lowest and highest intercepts
+ * @details Parallel lines are vertically collinear dual points, of which the hull only ever needs the two ends. Keeping
+ * the others out of the tree also keeps it clear of three or more points on a vertical line.
+ */
+void LineEnvelope::replaceExtremes(double slope, const std::set<double> &before, const std::set<double> &after) {
+    for (double intercept: before) {
+        if (after.count(intercept) == 0) tree.remove(Point(slope, intercept));
+    }
+    for (double intercept: after) {
+        if (before.count(intercept) == 0) tree.insert(slope, intercept);
+    }
+}
+
+bool LineEnvelope::empty() const {
+    return intercepts.empty();
+}
+
+/**
+ * @brief Evaluates the upper or lower envelope at x
+ * @param maximize Whether to return the largest or the smallest value of any line at x
+ * @return The extreme value, or nothing if there are no lines
+ * @details One extreme point search on the root hull, O(log h).
+ */
+std::optional<double> LineEnvelope::evaluate(double x, bool maximize) {
+    double sign = maximize ? 1 : -1;
+    std::optional<Point> line = tree.extreme(Direction(sign * x, sign));
+    if (not line) return std::nullopt;
+    return line->x * x + line->y;
+}
+
+std::optional<double> LineEnvelope::maximum(double x) {
+    return evaluate(x, true);
+}
+
+std::optional<double> LineEnvelope::minimum(double x) {
+    return evaluate(x, false);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file LineEnvelope.h
+ * @brief The upper and lower envelopes of a dynamic set of lines y = m * x + b, kept as a TTree of dual points.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_LINEENVELOPE_H
+#define DYNAMICCONVEXHULL_LINEENVELOPE_H
+
+#include <map>
+#include <optional>
+#include <set>
+#include "TTree.h"
+
+class LineEnvelope {
+public:
+    // Every line y = m * x + b that can be on an envelope is stored as the dual point (m, b)
+    TTree tree;
+    // The intercepts of all lines by slope, only the smallest and largest of each slope are in the tree
+    std::map<double, std::set<double>> intercepts;
+
+    bool insert(double slope, double intercept);
+
+    bool remove(double slope, double intercept);
+
+    bool empty() const;
+
+    std::optional<double> evaluate(double x, bool maximize = true);
+
+    std::optional<double> maximum(double x);
+
+    std::optional<double> minimum(double x);
+
+private:
+    void replaceExtremes(double slope, const std::set<double> &before, const std::set<double> &after);
+};
+
+
+#endif //DYNAMICCONVEXHULL_LINEENVELOPE_H
@@ -0,0 +1,90 @@
+/**
+ * @file ParallelTTree.cpp
+ * @date 10/19/26
+ * @details The lower and upper hulls of a node are split and merged independently, so the calling thread keeps
+ * working on the lower hulls and posts the matching work on the upper hulls to a helper thread. A posted task names
+ * the queues it works on instead of the nodes, so the skeleton may change before the helper gets to it. The only
+ * synchronization is waiting for the helper after every descend, since the skeleton is rotated or nodes are freed
+ * right after, and when the outermost ascend returns, after which any query may read the upper hull.
+ */
+
+#include "ParallelTTree.h"
+
+// Idle polls of the helper before it goes to sleep
+static const int SPINS = 1 << 12;
+
+ParallelTTree::ParallelTTree() : helper([this]() { run(); }) {}
+
+ParallelTTree::~ParallelTTree() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    helper.join();
+}
+
+void ParallelTTree::descend(TTree::TNode *&n) {
+    if (n->isLeaf or n->lower_hull->root == nullptr) {
+        return;
+    }
+    post(Task{false, n->upper_hull, n->left->upper_hull, n->right->upper_hull});
+    n->lower_hull->splitHull(n->left->lower_hull, n->right->lower_hull);
+    wait();
+}
+
+void ParallelTTree::ascend(TTree::TNode *&n) {
+    if (n->isLeaf or n->lower_hull->root != nullptr) {
+        return;
+    }
+    depth++;
+    if (n->left->lower_hull->root == nullptr) ascend(n->left);
+    if (n->right->lower_hull->root == nullptr) ascend(n->right);
+    // The helper runs tasks in order, so the children are merged before this node
+    post(Task{true, n->upper_hull, n->left->upper_hull, n->right->upper_hull});
+    n->lower_hull->mergeHulls(n->left->lower_hull, n->right->lower_hull);
+    depth--;
+    if (depth == 0) wait();
+}
+
+void ParallelTTree::post(Task task) {
+    std::size_t next = posted.load();
+    while (next - done.load() == CAPACITY) std::this_thread::yield();
+    tasks[next % CAPACITY] = task;
+    posted.store(next + 1);
+    if (sleeping.load()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake.notify_one();
+    }
+}
+
+// Waits until the helper has run every posted task
+void ParallelTTree::wait() {
+    while (done.load() != posted.load()) std::this_thread::yield();
+}
+
+void ParallelTTree::run() {
+    std::size_t next = 0;
+    while (true) {
+        int spins = 0;
+        while (posted.load() == next and spins < SPINS) {
+            std::this_thread::yield();
+            spins++;
+        }
+        if (posted.load() == next) {
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping.store(true);
+            wake.wait(lock, [&]() { return posted.load() != next or stopping; });
+            sleeping.store(false);
+            if (posted.load() == next) return;
+        }
+        Task &task = tasks[next % CAPACITY];
+        if (task.merge) {
+            task.hull->mergeHulls(task.left, task.right);
+        } else {
+            task.hull->splitHull(task.left, task.right);
+        }
+        next++;
+        done.store(next);
+    }
+}
@@ -0,0 +1,62 @@
+/**
+ * @file ParallelTTree.h
+ * @brief A child class of TTree that maintains the upper hulls on a helper thread by overriding the ascend and descend
+ * methods.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_PARALLELTTREE_H
+#define DYNAMICCONVEXHULL_PARALLELTTREE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include "TTree.h"
+
+class ParallelTTree : public TTree {
+public:
+    ParallelTTree();
+
+    ParallelTTree(const ParallelTTree &) = delete;
+
+    ParallelTTree &operator=(const ParallelTTree &) = delete;
+
+    ~ParallelTTree();
+
+    void ascend(TNode *&n) override;
+
+    void descend(TNode *&n) override;
+
+private:
+    // A split or merge of upper hulls, which only touches the three queues and never the skeleton
+    struct Task {
+        bool merge;
+        ConcatenableQueue *hull;
+        ConcatenableQueue *left;
+        ConcatenableQueue *right;
+    };
+
+    static const std::size_t CAPACITY = 256;
+
+    Task tasks[CAPACITY];
+    std::atomic<std::size_t> posted{0};
+    std::atomic<std::size_t> done{0};
+    // Nesting of ascend calls, the helper is waited for when the outermost one returns
+    int depth = 0;
+    std::atomic<bool> sleeping{false};
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread helper;
+
+    void post(Task task);
+
+    void wait();
+
+    void run();
+};
+
+
+#endif //DYNAMICCONVEXHULL_PARALLELTTREE_H
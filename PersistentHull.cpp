@@ -0,0 +1,362 @@
+/**
+ * @file PersistentHull.cpp
+ * @date 10/19/26
+ * @details The tree itself cannot be shared with readers, since every update splits the hull fragments down a path
+ * and merges them back in place. Readers only ever query the root hull though, so the writer keeps a second copy of
+ * its two chains as treaps and updates them from the hull deltas of the tree. The treaps are copied along the paths an
+ * update touches, which leaves every published version intact for readers still using it, and the copies made during
+ * one update are modified in place until it is published. A version is swapped in with one atomic store, and the
+ * nodes an update replaced are freed by an EpochReclaimer once no reader can still reach them.
+ */
+
+#include "PersistentHull.h"
+#include <cmath>
+#include <cstring>
+
+using Node = PersistentHull::Node;
+
+// Mixes the bits of a point into a treap priority, so that the shape of a treap only depends on its points
+static std::uint64_t priorityOf(const Point &p) {
+    std::uint64_t x;
+    std::uint64_t y;
+    std::memcpy(&x, &p.x, sizeof(x));
+    std::memcpy(&y, &p.y, sizeof(y));
+    std::uint64_t z = x ^ (y * 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static Node *leftmost(Node *n) {
+    while (n != nullptr and n->left != nullptr) n = n->left;
+    return n;
+}
+
+static Node *rightmost(Node *n) {
+    while (n != nullptr and n->right != nullptr) n = n->right;
+    return n;
+}
+
+static bool find(const Node *n, const Point &p) {
+    while (n != nullptr and n->point != p) n = p < n->point ? n->left : n->right;
+    return n != nullptr;
+}
+
+static void inOrder(const Node *n, std::vector<Point> &points) {
+    if (n == nullptr) return;
+    inOrder(n->left, points);
+    points.push_back(n->point);
+    inOrder(n->right, points);
+}
+
+// Appends the first two and last two vertices of a chain, the only ones that can move between the chains
+static void ends(Node *n, std::vector<Point> &points) {
+    std::vector<Node *> path;
+    for (Node *m = n; m != nullptr; m = m->left) path.push_back(m);
+    if (path.empty()) return;
+    Node *first = path.back();
+    points.push_back(first->point);
+    Node *second = first->right != nullptr ? leftmost(first->right) : path.size() > 1 ? path[path.size() - 2] : nullptr;
+    if (second != nullptr) points.push_back(second->point);
+    path.clear();
+    for (Node *m = n; m != nullptr; m = m->right) path.push_back(m);
+    Node *last = path.back();
+    points.push_back(last->point);
+    Node *beforeLast = last->left != nullptr ? rightmost(last->left) : path.size() > 1 ? path[path.size() - 2] : nullptr;
+    if (beforeLast != nullptr) points.push_back(beforeLast->point);
+}
+
+// Appends the finite points of an angle at the end of a chain of the tree
+static void ends(const Angle &angle, std::vector<Point> &points) {
+    for (const Point &p: {angle.left, angle.middle, angle.right}) {
+        if (not std::isinf(p.y)) points.push_back(p);
+    }
+}
+
+// Whether p, with x coordinate in the range of the chain, is on or above the lower chain
+static bool aboveLower(const Node *n, const Point &p) {
+    const Node *before = nullptr;
+    const Node *after = nullptr;
+    while (n != nullptr) {
+        if (n->point.x >= p.x) {
+            after = n;
+            n = n->left;
+        } else {
+            before = n;
+            n = n->right;
+        }
+    }
+    if (before == nullptr or after->point.x == p.x) return p.y >= after->point.y;
+    return Angle::turn(before->point, after->point, p) >= 0;
+}
+
+// Whether p, with x coordinate in the range of the chain, is on or below the upper chain
+static bool belowUpper(const Node *n, const Point &p) {
+    const Node *before = nullptr;
+    const Node *after = nullptr;
+    while (n != nullptr) {
+        if (n->point.x <= p.x) {
+            before = n;
+            n = n->right;
+        } else {
+            after = n;
+            n = n->left;
+        }
+    }
+    if (after == nullptr or before->point.x == p.x) return p.y <= before->point.y;
+    return Angle::turn(before->point, after->point, p) <= 0;
+}
+
+bool PersistentHull::Version::empty() const {
+    return lower == nullptr;
+}
+
+/**
+ * @brief Determines whether p is inside or on the boundary of the hull, O(log h)
+ */
+bool PersistentHull::Version::contains(Point p) const {
+    if (empty() or p.x < leftmost(lower)->point.x or p.x > rightmost(lower)->point.x) return false;
+    return aboveLower(lower, p) and belowUpper(upper, p);
+}
+
+/**
+ * @brief Finds a hull vertex maximizing the dot product with d
+ * @details The dot product is unimodal along the upper chain for directions pointing up and along the lower chain
+ * otherwise, so the first vertex that is no worse than the next one is binary searched. Finding the next vertex costs
+ * O(log h), O(log^2 h) in total.
+ */
+std::optional<Point> PersistentHull::Version::extreme(Direction d) const {
+    const Node *n = d.y > 0 ? upper : lower;
+    if (n == nullptr) return std::nullopt;
+    auto value = [&](const Point &p) { return d.x * p.x + d.y * p.y; };
+    const Node *best = nullptr;
+    const Node *after = nullptr;
+    while (n != nullptr) {
+        const Node *next = n->right != nullptr ? leftmost(n->right) : after;
+        if (next == nullptr or value(n->point) >= value(next->point)) {
+            best = n;
+            after = n;
+            n = n->left;
+        } else {
+            n = n->right;
+        }
+    }
+    return best->point;
+}
+
+/**
+ * @brief The hull vertices in the same order as TTree::getHull, the lower chain from left to right and then the upper
+ * chain back, without repeating the shared ends
+ */
+std::vector<Point> PersistentHull::Version::getHull() const {
+    std::vector<Point> hull;
+    inOrder(lower, hull);
+    std::vector<Point> top;
+    inOrder(upper, top);
+    for (auto it = top.rbegin(); it != top.rend(); ++it) {
+        if (*it != hull.back() and *it != hull.front()) hull.push_back(*it);
+    }
+    return hull;
+}
+
+PersistentHull::Reader::Reader(PersistentHull &hull) : hull(hull), epochs(hull.epochs) {}
+
+/**
+ * @brief Pins the current version, which stays valid until the next call to pin or unpin
+ */
+const PersistentHull::Version *PersistentHull::Reader::pin() {
+    epochs.pin();
+    return hull.current.load();
+}
+
+void PersistentHull::Reader::unpin() {
+    epochs.unpin();
+}
+
+bool PersistentHull::Reader::contains(Point p) {
+    bool inside = pin()->contains(p);
+    unpin();
+    return inside;
+}
+
+std::optional<Point> PersistentHull::Reader::extreme(Direction d) {
+    std::optional<Point> vertex = pin()->extreme(d);
+    unpin();
+    return vertex;
+}
+
+std::vector<Point> PersistentHull::Reader::getHull() {
+    std::vector<Point> hull = pin()->getHull();
+    unpin();
+    return hull;
+}
+
+/**
+ * @brief Publishes the current hull of the tree and follows its inserts and removes from then on
+ * @details Follows them through a hull observer added to the tree. Other updates such as removeRange or concatenate are
+ * not reported, call refresh after them.
+ */
+PersistentHull::PersistentHull(TTree &tree) : tree(tree) {
+    current.store(new Version{0, nullptr, nullptr});
+    refresh();
+    observer = tree.addHullObserver([this](const HullDelta &delta) { update(delta); });
+}
+
+/**
+ * @brief Frees every version, no reader may be using this any more
+ */
+PersistentHull::~PersistentHull() {
+    tree.removeHullObserver(observer);
+    destroy(lower);
+    destroy(upper);
+    delete current.load();
+}
+
+void PersistentHull::destroy(Node *n) {
+    if (n == nullptr) return;
+    destroy(n->left);
+    destroy(n->right);
+    delete n;
+}
+
+/**
+ * @brief Rebuilds the chains from the tree and publishes them as a new version, O(h log h)
+ */
+void PersistentHull::refresh() {
+    std::vector<Point> points;
+    inOrder(lower, points);
+    inOrder(upper, points);
+    for (const Point &p: points) track(p);
+    if (tree.root != nullptr) {
+        for (const Point &p: tree.hull()) track(p);
+    }
+    publish();
+}
+
+// The number of the newest published version
+std::uint64_t PersistentHull::version() const {
+    return current.load()->number;
+}
+
+/**
+ * @brief Applies the delta of one update of the tree and publishes the result
+ * @details Besides the vertices that entered or left the hull, the vertices at the ends of the chains can move from one
+ * chain to both or the other way when the leftmost or rightmost point changes, so those are checked too. If the chains
+ * end up with other sizes than those of the tree anyway, they are rebuilt instead of drifting further from it.
+ */
+void PersistentHull::update(const HullDelta &delta) {
+    std::vector<Point> points(delta.left);
+    points.insert(points.end(), delta.entered.begin(), delta.entered.end());
+    ends(lower, points);
+    ends(upper, points);
+    if (tree.root != nullptr) {
+        for (ConcatenableQueue *chain: {tree.root->lower_hull, tree.root->upper_hull}) {
+            ends(chain->root->min->angle, points);
+            ends(chain->root->max->angle, points);
+        }
+    }
+    for (const Point &p: points) track(p);
+    bool empty = tree.root == nullptr;
+    if (lowerSize != (empty ? 0 : tree.root->lower_hull->size()) or
+        upperSize != (empty ? 0 : tree.root->upper_hull->size())) {
+        refresh();
+        return;
+    }
+    publish();
+}
+
+// Makes the chains agree with the root hull of the tree on whether they contain p
+void PersistentHull::track(const Point &p) {
+    bool inLower = tree.root != nullptr and ConcatenableQueue::Iterator::find(tree.root->lower_hull->root, p).valid();
+    bool inUpper = tree.root != nullptr and ConcatenableQueue::Iterator::find(tree.root->upper_hull->root, p).valid();
+    if (inLower != find(lower, p)) {
+        lower = inLower ? insert(lower, p) : erase(lower, p);
+        lowerSize += inLower ? 1 : -1;
+    }
+    if (inUpper != find(upper, p)) {
+        upper = inUpper ? insert(upper, p) : erase(upper, p);
+        upperSize += inUpper ? 1 : -1;
+    }
+}
+
+/**
+ * @brief Swaps in the version that was built and retires what it replaced
+ */
+void PersistentHull::publish() {
+    const Version *old = current.load();
+    current.store(new Version{next, lower, upper});
+    epochs.retire([old, nodes = std::move(replaced)]() {
+        for (Node *n: nodes) delete n;
+        delete old;
+    });
+    replaced.clear();
+    epochs.advance();
+    next++;
+}
+
+// A node that may be modified, n itself if the version being built created it and a copy otherwise
+Node *PersistentHull::writable(Node *n) {
+    if (n->version == next) return n;
+    replaced.push_back(n);
+    Node *copy = new Node(*n);
+    copy->version = next;
+    return copy;
+}
+
+// Drops a node from the version being built
+void PersistentHull::discard(Node *n) {
+    if (n->version == next) {
+        delete n;
+    } else {
+        replaced.push_back(n);
+    }
+}
+
+// Splits a treap into the points before p and the rest, copying the path to p
+std::pair<Node *, Node *> PersistentHull::split(Node *n, const Point &p) {
+    if (n == nullptr) return {nullptr, nullptr};
+    Node *c = writable(n);
+    if (c->point < p) {
+        auto [l, r] = split(c->right, p);
+        c->right = l;
+        return {c, r};
+    }
+    auto [l, r] = split(c->left, p);
+    c->left = r;
+    return {l, c};
+}
+
+// Joins two treaps whose points are all ordered, copying their inner spines
+Node *PersistentHull::merge(Node *a, Node *b) {
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
+    if (a->priority > b->priority) {
+        Node *c = writable(a);
+        c->right = merge(c->right, b);
+        return c;
+    }
+    Node *c = writable(b);
+    c->left = merge(a, c->left);
+    return c;
+}
+
+Node *PersistentHull::insert(Node *root, const Point &p) {
+    auto [l, r] = split(root, p);
+    return merge(merge(l, new Node{p, priorityOf(p), next, nullptr, nullptr}), r);
+}
+
+// Removes p, which must be in the treap
+Node *PersistentHull::erase(Node *n, const Point &p) {
+    if (n->point == p) {
+        Node *rest = merge(n->left, n->right);
+        discard(n);
+        return rest;
+    }
+    Node *c = writable(n);
+    if (p < c->point) {
+        c->left = erase(c->left, p);
+    } else {
+        c->right = erase(c->right, p);
+    }
+    return c;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file PersistentHull.h
+ * @brief Immutable versions of the root hull of a TTree that reader threads can query while a single writer keeps
+ * updating the tree.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_PERSISTENTHULL_H
+#define DYNAMICCONVEXHULL_PERSISTENTHULL_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "EpochReclaimer.h"
+#include "TTree.h"
+
+class PersistentHull {
+public:
+    // A node of a treap over the vertices of one chain, never modified once a version containing it is published
+    struct Node {
+        Point point;
+        std::uint64_t priority;
+        std::uint64_t version;
+        Node *left;
+        Node *right;
+    };
+
+    // The lower and upper chains of the root hull from left to right at one point in time
+    struct Version {
+        std::uint64_t number;
+        Node *lower;
+        Node *upper;
+
+        bool empty() const;
+
+        bool contains(Point p) const;
+
+        std::optional<Point> extreme(Direction d) const;
+
+        std::vector<Point> getHull() const;
+    };
+
+    /**
+     * @brief A handle for one reader thread. Every query pins the current version for its duration, which costs two
+     * atomic stores and never waits for the writer. At most EpochReclaimer::MAX_READERS readers can exist at once.
+     */
+    class Reader {
+    public:
+        explicit Reader(PersistentHull &hull);
+
+        Reader(const Reader &) = delete;
+
+        Reader &operator=(const Reader &) = delete;
+
+        const Version *pin();
+
+        void unpin();
+
+        bool contains(Point p);
+
+        std::optional<Point> extreme(Direction d);
+
+        std::vector<Point> getHull();
+
+    private:
+        PersistentHull &hull;
+        EpochReclaimer::Reader epochs;
+    };
+
+    explicit PersistentHull(TTree &tree);
+
+    PersistentHull(const PersistentHull &) = delete;
+
+    PersistentHull &operator=(const PersistentHull &) = delete;
+
+    ~PersistentHull();
+
+    void refresh();
+
+    std::uint64_t version() const;
+
+private:
+    TTree &tree;
+    // The handle of the hull observer following the tree
+    int observer;
+    std::atomic<const Version *> current{nullptr};
+    EpochReclaimer epochs;
+    // Writer state, the version being built and the nodes it replaced
+    std::uint64_t next = 1;
+    Node *lower = nullptr;
+    Node *upper = nullptr;
+    int lowerSize = 0;
+    int upperSize = 0;
+    std::vector<Node *> replaced;
+
+    void update(const HullDelta &delta);
+
+    void track(const Point &p);
+
+    void publish();
+
+    Node *writable(Node *n);
+
+    void discard(Node *n);
+
+    std::pair<Node *, Node *> split(Node *n, const Point &p);
+
+    Node *merge(Node *a, Node *b);
+
+    Node *insert(Node *root, const Point &p);
+
+    Node *erase(Node *n, const Point &p);
+
+    static void destroy(Node *n);
+};
+
+
+#endif //DYNAMICCONVEXHULL_PERSISTENTHULL_H
@@ -0,0 +1,217 @@
+/**
+ * @file ShardedHull.cpp
+ * @date 10/19/26
+ * @details Every shard is a TTree behind an UpdateService, so updates of different shards run in parallel on their
+ * writer threads and each shard publishes a HullSnapshot after every batch. The global hull is merged from the
+ * published snapshots from left to right: the chain merged so far and the next shard are separated by x, so they are
+ * joined by their bridge, found by walking back along the merged chain and forward along the shard like the merge step
+ * of divide and conquer. The shards are only read, and a vertex dropped by a bridge is never visited again, so the
+ * merge is linear in the sizes of the shard hulls.
+ *
+ * Boundaries start evenly spaced over the expected range. Once the sizes counted by the writers skew, every writer is
+ * drained, the shards are concatenated into one tree and split again at the quantiles of their points, which only
+ * moves the O(log n) nodes along the split paths.
+ */
+
+#include "ShardedHull.h"
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+using TNode = TTree::TNode;
+
+// How many updates pass between checks for skew
+static const long CHECK_INTERVAL = 1024;
+// Shards smaller than this never count as skewed, moving their points is not worth draining every writer
+static const long MIN_IMBALANCE = 256;
+
+static void collectX(const TNode *n, std::vector<double> &xs) {
+    if (n == nullptr) return;
+    if (n->isLeaf) {
+        xs.push_back(n->point.x);
+        return;
+    }
+    collectX(n->left, xs);
+    collectX(n->right, xs);
+}
+
+/**
+ * @brief Appends a chain right of the merged chain, dropping the vertices that end up above the lower bridge or below
+ * the upper one
+ * @param turn 1 for lower chains, which turn counter clockwise, and -1 for upper chains
+ */
+static void bridge(std::vector<Point> &chain, const std::vector<double> &xs, const std::vector<double> &ys, int turn) {
+    std::size_t j = 0;
+    bool moved = true;
+    while (moved) {
+        moved = false;
+        Point b(xs[j], ys[j]);
+        while (chain.size() >= 2 and turn * Angle::turn(chain[chain.size() - 2], chain.back(), b) <= 0) {
+            chain.pop_back();
+            moved = true;
+        }
+        while (not chain.empty() and j + 1 < xs.size() and
+               turn * Angle::turn(chain.back(), b, Point(xs[j + 1], ys[j + 1])) <= 0) {
+            j++;
+            b = Point(xs[j], ys[j]);
+            moved = true;
+        }
+    }
+    for (; j < xs.size(); j++) chain.emplace_back(xs[j], ys[j]);
+}
+
+/**
+ * @brief Starts a writer for each of count shards splitting [left, right) evenly, the outer shards extend to infinity
+ */
+ShardedHull::ShardedHull(int count, double left, double right) {
+    assert(count >= 1);
+    for (int i = 0; i < count; i++) shards.push_back(std::make_unique<Shard>());
+    for (int i = 1; i < count; i++) bounds.push_back(left + (right - left) * i / count);
+    start();
+}
+
+/**
+ * @brief Applies every update submitted so far and stops the writers
+ */
+ShardedHull::~ShardedHull() {
+    for (auto &shard: shards) shard->service.reset();
+}
+
+void ShardedHull::start() {
+    for (auto &shard: shards) {
+        Shard *s = shard.get();
+        s->service = std::make_unique<UpdateService>(s->tree, [s]() { s->publisher.publish(); });
+    }
+}
+
+/**
+ * @brief The number of points in the shard after the updates its writer applied so far
+ * @details Counted from what the writer did rather than from the routed requests, so inserts of points already present
+ * and removes of missing ones do not count.
+ */
+long ShardedHull::Shard::points() {
+    return initialPoints + service->metrics().pointChange;
+}
+
+ShardedHull::Shard &ShardedHull::shardOf(double x) {
+    return *shards[std::upper_bound(bounds.begin(), bounds.end(), x) - bounds.begin()];
+}
+
+/**
+ * @brief Queues an insert on the writer of the shard of p, can be called from any thread
+ * @return A future holding what TTree::insert returns, ready once p is part of the published hull of its shard
+ */
+std::future<bool> ShardedHull::insert(Point p) {
+    std::future<bool> result;
+    {
+        std::shared_lock<std::shared_mutex> lock(routing);
+        result = shardOf(p.x).service->insert(p);
+    }
+    checkBalance();
+    return result;
+}
+
+/**
+ * @brief Queues a remove on the writer of the shard of p, can be called from any thread
+ */
+std::future<bool> ShardedHull::remove(Point p) {
+    std::future<bool> result;
+    {
+        std::shared_lock<std::shared_mutex> lock(routing);
+        result = shardOf(p.x).service->remove(p);
+    }
+    checkBalance();
+    return result;
+}
+
+/**
+ * @brief The lower hull of all points from left to right, merged from the published shard hulls
+ */
+std::vector<Point> ShardedHull::getLowerHull() {
+    std::shared_lock<std::shared_mutex> lock(routing);
+    std::vector<Point> chain;
+    for (auto &shard: shards) {
+        SnapshotPublisher::Reader reader(shard->publisher);
+        const HullSnapshot *snapshot = reader.pin();
+        if (not snapshot->empty()) bridge(chain, snapshot->lowerX, snapshot->lowerY, 1);
+    }
+    return chain;
+}
+
+/**
+ * @brief The upper hull of all points from left to right, merged from the published shard hulls
+ */
+std::vector<Point> ShardedHull::getUpperHull() {
+    std::shared_lock<std::shared_mutex> lock(routing);
+    std::vector<Point> chain;
+    for (auto &shard: shards) {
+        SnapshotPublisher::Reader reader(shard->publisher);
+        const HullSnapshot *snapshot = reader.pin();
+        if (not snapshot->empty()) bridge(chain, snapshot->upperX, snapshot->upperY, -1);
+    }
+    return chain;
+}
+
+/**
+ * @brief The hull vertices in the same order as TTree::getHull
+ * @details Both chains are merged from the same snapshots, so they agree even while the writers keep publishing.
+ */
+std::vector<Point> ShardedHull::getHull() {
+    std::shared_lock<std::shared_mutex> lock(routing);
+    std::vector<Point> hull;
+    std::vector<Point> top;
+    for (auto &shard: shards) {
+        SnapshotPublisher::Reader reader(shard->publisher);
+        const HullSnapshot *snapshot = reader.pin();
+        if (snapshot->empty()) continue;
+        bridge(hull, snapshot->lowerX, snapshot->lowerY, 1);
+        bridge(top, snapshot->upperX, snapshot->upperY, -1);
+    }
+    for (auto it = top.rbegin(); it != top.rend(); ++it) {
+        if (*it != hull.back() and *it != hull.front()) hull.push_back(*it);
+    }
+    return hull;
+}
+
+/**
+ * @brief Whether some shard holds more than one and a half times its share of the points, ignoring small imbalances
+ */
+bool ShardedHull::isSkewed() {
+    std::shared_lock<std::shared_mutex> lock(routing);
+    long total = 0;
+    long largest = 0;
+    for (auto &shard: shards) {
+        long load = shard->points();
+        total += load;
+        largest = std::max(largest, load);
+    }
+    return 2 * largest > 3 * total / static_cast<long>(shards.size()) + 2 * MIN_IMBALANCE;
+}
+
+void ShardedHull::checkBalance() {
+    if (shards.size() > 1 and ++updates % CHECK_INTERVAL == 0 and isSkewed()) rebalance();
+}
+
+/**
+ * @brief Moves the boundaries to the quantiles of the points so that every shard holds about as many, O(n)
+ * @details Waits for every queued update to be applied and blocks updates and queries while the points move.
+ */
+void ShardedHull::rebalance() {
+    std::unique_lock<std::shared_mutex> lock(routing);
+    for (auto &shard: shards) shard->service.reset();
+    std::vector<double> xs;
+    for (auto &shard: shards) collectX(shard->tree.root, xs);
+    TTree &all = shards[0]->tree;
+    for (std::size_t i = 1; i < shards.size(); i++) all.concatenate(std::move(shards[i]->tree));
+    for (std::size_t i = 1; i < shards.size() and not xs.empty(); i++) {
+        bounds[i - 1] = xs[xs.size() * i / shards.size()];
+    }
+    for (std::size_t i = shards.size() - 1; i >= 1; i--) shards[i]->tree = all.splitAt(bounds[i - 1]);
+    for (std::size_t i = 0; i < shards.size(); i++) {
+        auto begin = i == 0 ? xs.begin() : std::lower_bound(xs.begin(), xs.end(), bounds[i - 1]);
+        auto end = i + 1 == shards.size() ? xs.end() : std::lower_bound(xs.begin(), xs.end(), bounds[i]);
+        shards[i]->initialPoints = end - begin;
+        shards[i]->publisher.publish();
+    }
+    start();
+}
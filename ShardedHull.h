@@ -0,0 +1,69 @@
+/**
+ * @file ShardedHull.h
+ * @brief A hull split by x coordinate into several TTrees, each updated by its own writer thread.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_SHARDEDHULL_H
+#define DYNAMICCONVEXHULL_SHARDEDHULL_H
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+#include "SnapshotPublisher.h"
+#include "UpdateService.h"
+
+class ShardedHull {
+public:
+    // The points with x coordinate in one range, published after every batch its writer applies
+    struct Shard {
+        TTree tree;
+        SnapshotPublisher publisher{tree, false};
+        std::unique_ptr<UpdateService> service;
+        // The number of points when the writer started, its metrics count the change since
+        long initialPoints = 0;
+
+        long points();
+    };
+
+    // Shard i holds the points with bounds[i - 1] <= x < bounds[i]
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<double> bounds;
+    // Shared by updates and queries, held exclusively while points move between shards
+    std::shared_mutex routing;
+    std::atomic<long> updates{0};
+
+    ShardedHull(int count, double left, double right);
+
+    ShardedHull(const ShardedHull &) = delete;
+
+    ShardedHull &operator=(const ShardedHull &) = delete;
+
+    ~ShardedHull();
+
+    std::future<bool> insert(Point p);
+
+    std::future<bool> remove(Point p);
+
+    std::vector<Point> getLowerHull();
+
+    std::vector<Point> getUpperHull();
+
+    std::vector<Point> getHull();
+
+    bool isSkewed();
+
+    void rebalance();
+
+private:
+    Shard &shardOf(double x);
+
+    void start();
+
+    void checkBalance();
+};
+
+
+#endif //DYNAMICCONVEXHULL_SHARDEDHULL_H
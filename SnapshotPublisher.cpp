@@ -0,0 +1,82 @@
+/**
+ * @file SnapshotPublisher.cpp
+ * @date 10/19/26
+ * @details Every publish copies the root hull into a HullSnapshot no reader can reach and swaps it in with one atomic
+ * store. A published snapshot is never written again, so readers share it without any synchronization beyond pinning,
+ * and they touch no memory the writer writes except the epoch counter and the published pointer. Replaced snapshots
+ * are retired to an EpochReclaimer and, once no reader can reach them, reused for later copies so that their buffers
+ * are only allocated while the hull grows.
+ */
+
+#include "SnapshotPublisher.h"
+
+SnapshotPublisher::Reader::Reader(SnapshotPublisher &publisher) : publisher(publisher), epochs(publisher.epochs) {}
+
+/**
+ * @brief Pins the current snapshot, which stays valid until the next call to pin or unpin
+ */
+const HullSnapshot *SnapshotPublisher::Reader::pin() {
+    epochs.pin();
+    return publisher.current.load();
+}
+
+void SnapshotPublisher::Reader::unpin() {
+    epochs.unpin();
+}
+
+bool SnapshotPublisher::Reader::contains(double x, double y) {
+    bool inside = pin()->contains(x, y);
+    unpin();
+    return inside;
+}
+
+std::optional<Point> SnapshotPublisher::Reader::extreme(Direction d) {
+    std::optional<Point> vertex = pin()->extreme(d);
+    unpin();
+    return vertex;
+}
+
+void SnapshotPublisher::Reader::classify(const double *x, const double *y, std::size_t n, std::uint8_t *inside) {
+    pin()->classify(x, y, n, inside);
+    unpin();
+}
+
+/**
+ * @brief Publishes the current hull of the tree
+ * @param everyUpdate Whether to publish again after every insert or remove that changes the hull, from a hull observer
+ * added to the tree. Otherwise the writer calls publish itself, for example after each batch of updates.
+ */
+SnapshotPublisher::SnapshotPublisher(TTree &tree, bool everyUpdate) : tree(tree) {
+    publish();
+    if (everyUpdate) observer = tree.addHullObserver([this](const HullDelta &) { publish(); });
+}
+
+/**
+ * @brief Frees every snapshot, no reader may be using this any more
+ */
+SnapshotPublisher::~SnapshotPublisher() {
+    if (observer >= 0) tree.removeHullObserver(observer);
+    delete current.load();
+    // With no reader pinned this returns every retired snapshot to the spares
+    epochs.advance();
+    for (HullSnapshot *snapshot: spare) delete snapshot;
+}
+
+/**
+ * @brief Copies the root hull of the tree and makes it the snapshot readers see, O(h)
+ */
+void SnapshotPublisher::publish() {
+    HullSnapshot *snapshot;
+    if (spare.empty()) {
+        snapshot = new HullSnapshot();
+    } else {
+        snapshot = spare.back();
+        spare.pop_back();
+    }
+    snapshot->update(tree);
+    const HullSnapshot *old = current.exchange(snapshot);
+    if (old != nullptr) {
+        epochs.retire([this, old]() { spare.push_back(const_cast<HullSnapshot *>(old)); });
+    }
+    epochs.advance();
+}
@@ -0,0 +1,67 @@
+/**
+ * @file SnapshotPublisher.h
+ * @brief Publishes immutable HullSnapshots of a TTree for reader threads, read copy update style.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_SNAPSHOTPUBLISHER_H
+#define DYNAMICCONVEXHULL_SNAPSHOTPUBLISHER_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "EpochReclaimer.h"
+#include "HullSnapshot.h"
+
+class SnapshotPublisher {
+public:
+    /**
+     * @brief A handle for one reader thread. Every query pins the current snapshot for its duration, which costs two
+     * atomic stores and never waits for the writer.
+     */
+    class Reader {
+    public:
+        explicit Reader(SnapshotPublisher &publisher);
+
+        Reader(const Reader &) = delete;
+
+        Reader &operator=(const Reader &) = delete;
+
+        const HullSnapshot *pin();
+
+        void unpin();
+
+        bool contains(double x, double y);
+
+        std::optional<Point> extreme(Direction d);
+
+        void classify(const double *x, const double *y, std::size_t n, std::uint8_t *inside);
+
+    private:
+        SnapshotPublisher &publisher;
+        EpochReclaimer::Reader epochs;
+    };
+
+    explicit SnapshotPublisher(TTree &tree, bool everyUpdate = true);
+
+    SnapshotPublisher(const SnapshotPublisher &) = delete;
+
+    SnapshotPublisher &operator=(const SnapshotPublisher &) = delete;
+
+    ~SnapshotPublisher();
+
+    void publish();
+
+private:
+    TTree &tree;
+    // The handle of the hull observer publishing after every update, -1 without one
+    int observer = -1;
+    std::atomic<const HullSnapshot *> current{nullptr};
+    EpochReclaimer epochs;
+    // Snapshots no reader can reach any more, kept for their buffers
+    std::vector<HullSnapshot *> spare;
+};
+
+
+#endif //DYNAMICCONVEXHULL_SNAPSHOTPUBLISHER_H
@@ -0,0 +1,107 @@
+/**
+ * @file SplitTTree.cpp
+ * @date 10/19/26
+ * @details Each tree keeps its own skeleton, so the two threads share nothing while an update runs and only meet once
+ * per update, at the cost of doing the skeleton work twice.
+ */
+
+#include "SplitTTree.h"
+#include <cassert>
+
+// Idle polls of the helper before it goes to sleep
+static const int SPINS = 1 << 12;
+
+ChainTTree::ChainTTree(bool upper) : upper(upper) {}
+
+ConcatenableQueue *ChainTTree::chain(TTree::TNode *n) const {
+    return upper ? n->upper_hull : n->lower_hull;
+}
+
+void ChainTTree::descend(TTree::TNode *&n) {
+    if (n->isLeaf or chain(n)->root == nullptr) {
+        return;
+    }
+    chain(n)->splitHull(chain(n->left), chain(n->right));
+}
+
+void ChainTTree::ascend(TTree::TNode *&n) {
+    if (n->isLeaf or chain(n)->root != nullptr) {
+        return;
+    }
+    if (chain(n->left)->root == nullptr) ascend(n->left);
+    if (chain(n->right)->root == nullptr) ascend(n->right);
+    chain(n)->mergeHulls(chain(n->left), chain(n->right));
+}
+
+SplitTTree::SplitTTree() : helper([this]() { run(); }) {}
+
+SplitTTree::~SplitTTree() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    helper.join();
+}
+
+bool SplitTTree::insert(Point p) {
+    return update(p, true);
+}
+
+bool SplitTTree::remove(Point p) {
+    return update(p, false);
+}
+
+// Applies the update to the upper tree on the helper and to the lower tree meanwhile
+bool SplitTTree::update(Point p, bool insert) {
+    point = p;
+    inserting = insert;
+    posted.store(true);
+    if (sleeping.load()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake.notify_one();
+    }
+    bool changed = insert ? lower.insert(p) : lower.remove(p);
+    while (posted.load()) std::this_thread::yield();
+    assert(changed == result);
+    return changed;
+}
+
+std::vector<Point> SplitTTree::getLowerHull() {
+    return lower.getLowerHull();
+}
+
+std::vector<Point> SplitTTree::getUpperHull() {
+    return upper.getUpperHull();
+}
+
+/**
+ * @brief The hull vertices in the same order as TTree::getHull
+ */
+std::vector<Point> SplitTTree::getHull() {
+    std::vector<Point> hull = getLowerHull();
+    std::vector<Point> top = getUpperHull();
+    for (auto it = top.rbegin(); it != top.rend(); ++it) {
+        if (*it != hull.back() and *it != hull.front()) hull.push_back(*it);
+    }
+    return hull;
+}
+
+void SplitTTree::run() {
+    while (true) {
+        int spins = 0;
+        while (not posted.load() and spins < SPINS) {
+            std::this_thread::yield();
+            spins++;
+        }
+        if (not posted.load()) {
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping.store(true);
+            wake.wait(lock, [&]() { return posted.load() or stopping; });
+            sleeping.store(false);
+            if (not posted.load()) return;
+        }
+        result = inserting ? upper.insert(point) : upper.remove(point);
+        posted.store(false);
+    }
+}
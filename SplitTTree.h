@@ -0,0 +1,76 @@
+/**
+ * @file SplitTTree.h
+ * @brief Maintains the lower and upper hulls in two separate trees over the same points, updated on two threads.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_SPLITTTREE_H
+#define DYNAMICCONVEXHULL_SPLITTTREE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TTree.h"
+
+/**
+ * @brief A child class of TTree that only maintains one of the two hulls, the other stays empty in every internal node.
+ * Only insert, remove and the getter of its hull may be used.
+ */
+class ChainTTree : public TTree {
+public:
+    explicit ChainTTree(bool upper);
+
+    void ascend(TNode *&n) override;
+
+    void descend(TNode *&n) override;
+
+private:
+    bool upper;
+
+    ConcatenableQueue *chain(TNode *n) const;
+};
+
+class SplitTTree {
+public:
+    ChainTTree lower{false};
+    ChainTTree upper{true};
+
+    SplitTTree();
+
+    SplitTTree(const SplitTTree &) = delete;
+
+    SplitTTree &operator=(const SplitTTree &) = delete;
+
+    ~SplitTTree();
+
+    bool insert(Point p);
+
+    bool remove(Point p);
+
+    std::vector<Point> getLowerHull();
+
+    std::vector<Point> getUpperHull();
+
+    std::vector<Point> getHull();
+
+private:
+    // The update the helper applies to the upper tree
+    Point point;
+    bool inserting = false;
+    bool result = false;
+    std::atomic<bool> posted{false};
+    std::atomic<bool> sleeping{false};
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread helper;
+
+    bool update(Point p, bool insert);
+
+    void run();
+};
+
+
+#endif //DYNAMICCONVEXHULL_SPLITTTREE_H
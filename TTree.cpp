@@ -12,6 +12,8 @@
 #include <cassert>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <cstdint>
 using QNode = ConcatenableQueue::QNode;
 /**
  * @brief Constructs a leaf node with the given point
@@ -19,7 +21,7 @@ using QNode = ConcatenableQueue::QNode;
  * @details The node is colored as black because the leaf nodes are always black in a red-black tree.
  * In this sense, the leaf nodes are analogous to the NIL nodes in a standard red-black tree.
  */
-TTree::TNode::TNode(Point p, TTree::TNode *par = nullptr) {
+TTree::TNode::TNode(Point p, TTree::TNode *par = nullptr, bool integral = false) {
     point = p;
     isLeaf = true;
     color = BLACK;
@@ -28,6 +30,8 @@ TTree::TNode::TNode(Point p, TTree::TNode *par = nullptr) {
     lMax = rMin = this;
     lower_hull = new ConcatenableQueue(p, ConcatenableQueue::LOWER);
     upper_hull = new ConcatenableQueue(p, ConcatenableQueue::UPPER);
+    lower_hull->integral = integral;
+    upper_hull->integral = integral;
 }
 
 /**
@@ -48,6 +52,17 @@ TTree::TNode::TNode(TTree::TNode *par, TTree::TNode *l, TTree::TNode *r) {
     r->parent = this;
     lower_hull = new ConcatenableQueue(ConcatenableQueue::LOWER);
     upper_hull = new ConcatenableQueue(ConcatenableQueue::UPPER);
+    lower_hull->integral = l->lower_hull->integral;
+    upper_hull->integral = l->upper_hull->integral;
+}
+
+/**
+ * @brief Frees the hull fragments owned by the node. Every QNode belongs to exactly one ConcatenableQueue so this
+ * never touches the hulls of other nodes.
+ */
+TTree::TNode::~TNode() {
+    delete lower_hull;
+    delete upper_hull;
 }
 
 bool TTree::TNode::operator<(const TTree::TNode &rhs) const {
@@ -75,13 +90,13 @@ bool TTree::TNode::operator>=(const TTree::TNode &rhs) const {
  */
 TTree::TNode *TTree::insert(Point &p, TTree::TNode *curr) {
     if (curr == nullptr) {
-        root = new TNode(p);
+        root = new TNode(p, nullptr, integral);
         return root;
     }
     if (curr->lMax->point == p or curr->rMin->point == p) return nullptr;
     if (curr->isLeaf) {
         if (curr->point == p){ return nullptr;}
-        TNode *newLeaf = new TNode(p);
+        TNode *newLeaf = new TNode(p, nullptr, integral);
         TNode *newInternal;
         if (p < curr->point) {
             newInternal = new TNode(curr->parent, newLeaf, curr);
@@ -169,6 +184,8 @@ TTree::TNode *TTree::remove(Point &p, TTree::TNode *n) {
         } else {
             return remove(p, n->right);
         }
+        // The spliced out node was replaced above, callers only check that the point was found
+        return n;
     }
 }
 
@@ -181,14 +198,7 @@ void TTree::rotateLeft(TTree::TNode *n) {
     TNode *rightNode = n->right;
     descend(rightNode);
 
-    if (n == root) {
-        root = rightNode;
-    } else if (n->parent->left == n) { // n is a left child
-        n->parent->left = rightNode;
-    } else {
-        n->parent->right = rightNode;
-    }
-    rightNode->parent = n->parent;
+    transplant(n, rightNode);
 
     n->right = rightNode->left;
     if (rightNode->left != nullptr) {
@@ -275,18 +285,223 @@ void TTree::fixUp(TTree::TNode *curr) {
     root->color = BLACK;
 }
 
+static bool isInt32(double v) {
+    return v == std::floor(v) and v >= INT32_MIN and v <= INT32_MAX;
+}
+
+/**
+ * @details With a hull observer the vertices that may leave the hull are found before the update, from one tangent
+ * vertex of p to the other. Hulls keep every point on their boundary, so the ones still on it afterwards are those on
+ * the line through p and a tangent vertex, or all of them when the old hull was a segment. They are dropped from the
+ * delta with a search each, so reporting it costs O(log h) per vertex.
+ */
 bool TTree::insert(Point p) {
+    assert(not integral or (isInt32(p.x) and isInt32(p.y)));
+    bool observed = not hullObservers.empty();
+    std::optional<std::pair<Point, Point>> t;
+    if (observed) {
+        delta.entered.clear();
+        delta.left.clear();
+        t = tangents(p);
+        if (t) collectChain(t->first, t->second, delta.left);
+    }
     TNode *newLeaf = insert(p, root);
     ascend(root);
-    return newLeaf != nullptr;
+    if (newLeaf == nullptr) return false;
+    if (observed) {
+        HullIterator end = HullIterator::end(root);
+        if (t) {
+            delta.left.insert(delta.left.begin(), t->first);
+            if (t->second != t->first) delta.left.push_back(t->second);
+        }
+        // Vertices on the line through p and a tangent vertex stay on the hull, as do all of them when it was a segment
+        std::erase_if(delta.left, [&](const Point &v) { return HullIterator::find(root, v) != end; });
+        if (HullIterator::find(root, p) != end) delta.entered.push_back(p);
+        if (not delta.entered.empty() or not delta.left.empty()) notifyHullObservers();
+    }
+    return true;
+}
+
+/**
+ * @brief Whether every vertex of the hull lies on the line through its leftmost and rightmost vertices, O(log h)
+ */
+static bool isSegment(TTree::TNode *root) {
+    const Point &first = root->lower_hull->root->min->angle.middle;
+    const Point &last = root->lower_hull->root->max->angle.middle;
+    Point down(last.y - first.y, first.x - last.x);
+    Point up(-down.x, -down.y);
+    return Angle::turn(first, last, root->lower_hull->findExtreme(down)->angle.middle) == 0 and
+           Angle::turn(first, last, root->upper_hull->findExtreme(up)->angle.middle) == 0;
 }
 
+/**
+ * @details With a hull observer the neighbours of p on the hull are recorded before the update, the vertices entering
+ * the hull are the ones between them afterwards, so reporting the delta costs O(log h) plus its size. When the hull
+ * collapses to a segment the other points were already on the old one, along its side opposite p.
+ */
 bool TTree::remove(Point p) {
-    bool found = remove(p, root);
-    ascend(root);
+    if (root == nullptr) return false;
+    bool observed = not hullObservers.empty();
+    HullIterator it = observed ? HullIterator::find(root, p) : HullIterator::end(root);
+    bool onHull = it != HullIterator::end(root);
+    Point before{};
+    Point after{};
+    if (onHull) {
+        HullIterator next = std::next(it);
+        after = next == HullIterator::end(root) ? *HullIterator::begin(root) : *next;
+        before = it == HullIterator::begin(root) ? *std::prev(HullIterator::end(root)) : *std::prev(it);
+    }
+    // Removing the only point empties the tree, which the recursion reports like a point that was not found
+    bool last = root->isLeaf and root->point == p;
+    bool found = remove(p, root) != nullptr or last;
+    if (root != nullptr) ascend(root);
+    if (found and onHull) {
+        delta.entered.clear();
+        delta.left.clear();
+        delta.left.push_back(p);
+        if (root != nullptr and not isSegment(root)) collectChain(before, after, delta.entered);
+        notifyHullObservers();
+    }
     return found;
 }
 
+/**
+ * @brief Appends the hull vertices strictly between from and to in counter clockwise order
+ */
+void TTree::collectChain(const Point &from, const Point &to, std::vector<Point> &chain) {
+    HullIterator it = HullIterator::find(root, from);
+    HullIterator end = HullIterator::end(root);
+    if (from == to or it == end) return;
+    for (int k = size(); k > 0; --k) {
+        if (++it == end) it = HullIterator::begin(root);
+        if (*it == to) return;
+        chain.push_back(*it);
+    }
+}
+
+/**
+ * @brief Calls observer after every insert or remove that changes the hull, after the observers added before it
+ * @return A handle that removes the observer again
+ * @details Updates that rebuild the tree, such as removeRange or concatenate, are not reported.
+ */
+int TTree::addHullObserver(std::function<void(const HullDelta &)> observer) {
+    hullObservers.emplace_back(nextObserver, std::move(observer));
+    return nextObserver++;
+}
+
+/**
+ * @brief Stops calling the observer added under handle
+ * @return false if no observer has that handle
+ */
+bool TTree::removeHullObserver(int handle) {
+    for (auto it = hullObservers.begin(); it != hullObservers.end(); ++it) {
+        if (it->first == handle) {
+            hullObservers.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TTree::notifyHullObservers() {
+    for (auto &[handle, observer]: hullObservers) observer(delta);
+}
+
+/**
+ * @brief Removes every point with x coordinate in [xLo, xHi]
+ * @param xLo The lower boundary of the strip, inclusive
+ * @param xHi The upper boundary of the strip, inclusive
+ * @return true if at least one point was removed
+ * @details The tree is split at both boundaries, the middle tree is recycled wholesale and the outer trees are joined
+ * back together. Only the O(log n) nodes on the two search paths lose their hulls, so the final ascend rebuilds the
+ * hull in O(log^2 n) time plus the time spent freeing the removed nodes.
+ */
+bool TTree::removeRange(double xLo, double xHi) {
+    if (root == nullptr or xLo > xHi) return false;
+    TNode *T = root;
+    root = nullptr;
+    auto [L, rest] = split(T, [&](Point p) { return p.x >= xLo; });
+    auto [M, R] = split(rest, [&](Point p) { return p.x > xHi; });
+    recycle(M);
+    root = join2(L, R);
+    if (root != nullptr) {
+        root->color = BLACK;
+        ascend(root);
+    }
+    return M != nullptr;
+}
+
+/**
+ * @brief Splits the tree by x coordinate
+ * @param x The boundary of the split
+ * @return A tree containing every point with x coordinate at least x, this tree keeps the points left of x
+ * @details Both trees are produced by the same join based split used by removeRange so only the search path is
+ * rebuilt, O(log^2 n) in total.
+ */
+TTree TTree::splitAt(double x) {
+    TTree right(integral);
+    if (root == nullptr) return right;
+    TNode *T = root;
+    root = nullptr;
+    auto [L, R] = split(T, [&](Point p) { return p.x >= x; });
+    root = L;
+    right.root = R;
+    if (root != nullptr) {
+        root->color = BLACK;
+        ascend(root);
+    }
+    if (right.root != nullptr) {
+        right.root->color = BLACK;
+        right.ascend(right.root);
+    }
+    return right;
+}
+
+/**
+ * @brief Appends every point of right to this tree, leaving right empty
+ * @param right A tree whose points are all greater than the points of this tree
+ * @details The skeletons are joined along the right spine of the taller tree and the hulls are merged with findBridge
+ * on the way back up, O(log^2 n) in total.
+ */
+void TTree::concatenate(TTree &&right) {
+    assert(integral == right.integral);
+    if (right.root == nullptr) return;
+    if (root != nullptr) {
+        assert(findMax(root)->point < findMin(right.root)->point);
+    }
+    TNode *T1 = root;
+    TNode *T2 = right.root;
+    root = nullptr;
+    right.root = nullptr;
+    root = join2(T1, T2);
+    root->color = BLACK;
+    ascend(root);
+}
+
+/**
+ * @brief The hull of the points with x coordinate in [xLo, xHi], in the same order as getHull
+ * @details The tree is split at both boundaries, the middle tree's hull is rebuilt along its O(log n) search paths and
+ * read off, and the three trees are joined back together. The tree is restored in O(log^2 n) and the query costs that
+ * plus the size of the output.
+ */
+std::vector<Point> TTree::hullInRange(double xLo, double xHi) {
+    std::vector<Point> hull;
+    if (root == nullptr or xLo > xHi) return hull;
+    TNode *T = root;
+    root = nullptr;
+    auto [L, rest] = split(T, [&](Point p) { return p.x >= xLo; });
+    auto [M, R] = split(rest, [&](Point p) { return p.x > xHi; });
+    if (M != nullptr) {
+        M->color = BLACK;
+        ascend(M);
+        for (const Point &p: HullView(M)) hull.push_back(p);
+    }
+    root = join2(join2(L, M), R);
+    root->color = BLACK;
+    ascend(root);
+    return hull;
+}
+
 // Pretty Prints all the Internal and Leaf nodes as they would appear in the tree with proper formatting and spacing.
 // Each point's x coordinate is printed and each internal node is printed as I.
 // The proper white space to be printed between nodes is calculated by the level and nodes are printed by their red or black color
@@ -340,6 +555,33 @@ TTree::TTree() {
     root = nullptr;
 }
 
+/**
+ * @brief An empty tree that only accepts points with 32 bit integer coordinates and merges its hulls exactly
+ * @details The orientation tests and the bridge search in ConcatenableQueue::findBridge are then evaluated in 128 bit
+ * integers, so merging never depends on rounding however close to collinear the points are.
+ */
+TTree::TTree(bool integral) : root(nullptr), integral(integral) {}
+
+TTree::TTree(TTree &&other) noexcept {
+    root = other.root;
+    integral = other.integral;
+    other.root = nullptr;
+    hullObservers = std::move(other.hullObservers);
+    nextObserver = other.nextObserver;
+}
+
+TTree &TTree::operator=(TTree &&other) noexcept {
+    if (this != &other) {
+        recycle(root);
+        root = other.root;
+        integral = other.integral;
+        other.root = nullptr;
+        hullObservers = std::move(other.hullObservers);
+        nextObserver = other.nextObserver;
+    }
+    return *this;
+}
+
 TTree::~TTree() {
     recycle(root);
 }
@@ -351,9 +593,128 @@ void TTree::recycle(TTree::TNode *n) {
     delete n;
 }
 
+/**
+ * @brief Makes k the internal node with children l and r
+ * @param k An internal node whose hulls are empty
+ * @param l Left child
+ * @param r Right child
+ * @details lMax and rMin are recomputed since l and r are arbitrary subtrees rather than leaves.
+ */
+void TTree::link(TTree::TNode *k, TTree::TNode *l, TTree::TNode *r) {
+    k->isLeaf = false;
+    k->left = l;
+    k->right = r;
+    l->parent = k;
+    r->parent = k;
+    k->lMax = findMax(l);
+    k->rMin = findMin(r);
+}
+
+/**
+ * @brief Counts the black nodes on the left spine of n, leaves count as black
+ */
+int TTree::blackHeight(TTree::TNode *n) {
+    int height = 0;
+    while (n != nullptr) {
+        if (n->color == BLACK) height++;
+        n = n->left;
+    }
+    return height;
+}
+
+/**
+ * @brief Joins two detached trees where every point in T1 is less than every point in T2
+ * @param T1 The "left" tree to be joined, may be nullptr
+ * @param k A spare internal node with empty hulls, it becomes the node joining the two trees and is deleted if
+ * either tree is empty
+ * @param T2 The "right" tree to be joined, may be nullptr
+ * @return A pointer to the new merged tree, its root may be red.
+ * @details This is the red-black join from Blelloch et al. adapted to the leaf oriented tree. Every node whose children
+ * change is descended first so that the next ascend recomputes exactly the hulls along the join path.
+ */
+TTree::TNode *TTree::join(TTree::TNode *T1, TTree::TNode *k, TTree::TNode *T2) {
+    if (T1 == nullptr or T2 == nullptr) {
+        delete k;
+        TNode *T = (T1 == nullptr) ? T2 : T1;
+        if (T != nullptr) T->parent = nullptr;
+        return T;
+    }
+    T1->parent = nullptr;
+    T2->parent = nullptr;
+    int t1BlackHeight = blackHeight(T1);
+    int t2BlackHeight = blackHeight(T2);
+    TNode *T;
+    if (t1BlackHeight > t2BlackHeight) {
+        T = joinRight(T1, k, T2, t1BlackHeight, t2BlackHeight);
+        if (T->color == RED and T->right->color == RED) T->color = BLACK;
+    } else if (t1BlackHeight < t2BlackHeight) {
+        T = joinLeft(T1, k, T2, t1BlackHeight, t2BlackHeight);
+        if (T->color == RED and T->left->color == RED) T->color = BLACK;
+    } else {
+        link(k, T1, T2);
+        k->color = (T1->color == BLACK and T2->color == BLACK) ? RED : BLACK;
+        T = k;
+    }
+    T->parent = nullptr;
+    return T;
+}
+
+/**
+ * @brief Joins two detached trees without a spare internal node, one is allocated if both trees are non empty
+ */
+TTree::TNode *TTree::join2(TTree::TNode *T1, TTree::TNode *T2) {
+    if (T1 == nullptr or T2 == nullptr) return join(T1, nullptr, T2);
+    return join(T1, new TNode(nullptr, T1, T2), T2);
+}
+
+/**
+ * @brief Helper function for join. Called when the black height of T1 is greater than the black height of T2.
+ * @details Traces down the right spine of T1 until a black node with the same black height as T2 is found, that node
+ * and T2 become the children of the red node k. A red-red violation is fixed with a single rotation on the way back up.
+ */
+TTree::TNode *TTree::joinRight(TTree::TNode *T1, TTree::TNode *k, TTree::TNode *T2, int t1BlackHeight,
+                               int t2BlackHeight) {
+    if (T1->color == BLACK and t1BlackHeight == t2BlackHeight) {
+        link(k, T1, T2);
+        k->color = RED;
+        return k;
+    }
+    descend(T1);
+    int childBlackHeight = (T1->color == BLACK) ? t1BlackHeight - 1 : t1BlackHeight;
+    T1->right = joinRight(T1->right, k, T2, childBlackHeight, t2BlackHeight);
+    T1->right->parent = T1;
+    if (T1->color == BLACK and T1->right->color == RED and T1->right->right->color == RED) {
+        T1->right->right->color = BLACK;
+        rotateLeft(T1);
+        return T1->parent;
+    }
+    return T1;
+}
+
+TTree::TNode *TTree::joinLeft(TTree::TNode *T1, TTree::TNode *k, TTree::TNode *T2, int t1BlackHeight,
+                              int t2BlackHeight) {
+    if (T2->color == BLACK and t1BlackHeight == t2BlackHeight) {
+        link(k, T1, T2);
+        k->color = RED;
+        return k;
+    }
+    descend(T2);
+    int childBlackHeight = (T2->color == BLACK) ? t2BlackHeight - 1 : t2BlackHeight;
+    T2->left = joinLeft(T1, k, T2->left, t1BlackHeight, childBlackHeight);
+    T2->left->parent = T2;
+    if (T2->color == BLACK and T2->left->color == RED and T2->left->left->color == RED) {
+        T2->left->left->color = BLACK;
+        rotateRight(T2);
+        return T2->parent;
+    }
+    return T2;
+}
+
 void TTree::transplant(TTree::TNode *u, TTree::TNode *v) {
     if (u == root) {
         root = v;
+    } else if (u->parent == nullptr) {
+        // u is the root of a detached subtree (see split and join), there is no parent to update
     } else if (u->parent->left == u) {
         u->parent->left = v;
     } else {
@@ -494,34 +855,1009 @@ void TTree::printLowerHull() {
 
 std::vector<Point> TTree::getLowerHull() {
     std::vector<Point> points;
-    ConcatenableQueue::getPoints(root->lower_hull->root, points);
+    if (root == nullptr) return points;
+    points.reserve(root->lower_hull->size());
+    for (auto it = ConcatenableQueue::Iterator::first(root->lower_hull->root); it.valid(); it.next()) {
+        points.push_back(it.node()->angle.middle);
+    }
     return points;
 }
 std::vector<Point> TTree::getUpperHull() {
     std::vector<Point> points;
-    ConcatenableQueue::getPoints(root->upper_hull->root, points);
+    if (root == nullptr) return points;
+    points.reserve(root->upper_hull->size());
+    for (auto it = ConcatenableQueue::Iterator::first(root->upper_hull->root); it.valid(); it.next()) {
+        points.push_back(it.node()->angle.middle);
+    }
     return points;
 }
 std::vector<Point> TTree::getHull() {
-    std::vector<Point> lower = getLowerHull();
-    std::vector<Point> upper = getUpperHull();
-    std::reverse(upper.begin(), upper.end()); // now upper is counterclockwise
-    if (lower.empty()){
-        return upper; 
+    std::vector<Point> points;
+    points.reserve(size());
+    for (const Point &p: hull()) points.push_back(p);
+    return points;
+}
+
+/**
+ * @brief The root hull in counter clockwise order as a range, see HullIterator
+ */
+TTree::HullView TTree::hull() {
+    return HullView(root);
+}
+
+// The number of vertices of the root hull
+static int hullSize(TTree::TNode *root) {
+    if (root->isLeaf) return 1;
+    QNode *lower = root->lower_hull->root;
+    QNode *upper = root->upper_hull->root;
+    int size = lower->size + upper->size;
+    // The hulls share their leftmost and rightmost vertices unless those are vertical edges
+    if (lower->min->angle.middle == upper->min->angle.middle) size--;
+    if (lower->max->angle.middle == upper->max->angle.middle) size--;
+    return size;
+}
+
+/**
+ * @brief The number of hull vertices, counted the same way as getHull
+ * @details Read from the aggregates at the roots of the two hulls in O(1).
+ */
+int TTree::size() {
+    if (root == nullptr) return 0;
+    return hullSize(root);
+}
+
+/**
+ * @brief The area of the hull in O(1)
+ * @details The shoelace sum of the counter clockwise boundary is the lower hull's cross product sum, minus the upper
+ * hull's since it is stored clockwise, plus the vertical edges joining their ends.
+ */
+double TTree::area() {
+    if (root == nullptr) return 0;
+    ConcatenableQueue *lower = root->lower_hull;
+    ConcatenableQueue *upper = root->upper_hull;
+    Point &lowerMin = lower->root->min->angle.middle;
+    Point &lowerMax = lower->root->max->angle.middle;
+    Point &upperMin = upper->root->min->angle.middle;
+    Point &upperMax = upper->root->max->angle.middle;
+    double crossSum = lower->crossSum() - upper->crossSum();
+    crossSum += lowerMax.x * upperMax.y - upperMax.x * lowerMax.y;
+    crossSum += upperMin.x * lowerMin.y - lowerMin.x * upperMin.y;
+    return 0.5 * crossSum;
+}
+
+/**
+ * @brief The perimeter of the hull in O(1)
+ */
+double TTree::perimeter() {
+    if (root == nullptr) return 0;
+    ConcatenableQueue *lower = root->lower_hull;
+    ConcatenableQueue *upper = root->upper_hull;
+    double perimeter = lower->lengthSum() + upper->lengthSum();
+    perimeter += std::abs(upper->root->max->angle.middle.y - lower->root->max->angle.middle.y);
+    perimeter += std::abs(upper->root->min->angle.middle.y - lower->root->min->angle.middle.y);
+    return perimeter;
+}
+
+TTree::HullIterator TTree::HullIterator::begin(TTree::TNode *root) {
+    HullIterator i;
+    i.root = root;
+    if (root == nullptr) return i;
+    i.onLower = true;
+    i.it = ConcatenableQueue::Iterator::first(root->lower_hull->root);
+    return i;
+}
+
+TTree::HullIterator TTree::HullIterator::end(TTree::TNode *root) {
+    HullIterator i;
+    i.root = root;
+    return i;
+}
+
+/**
+ * @brief Positions the iterator at the hull vertex v in O(log h), or at the end if v is not a hull vertex
+ */
+TTree::HullIterator TTree::HullIterator::find(TTree::TNode *root, const Point &v) {
+    HullIterator i = end(root);
+    if (root == nullptr) return i;
+    // Shared endpoints belong to the lower hull in the walk, so it is searched first
+    i.it = ConcatenableQueue::Iterator::find(root->lower_hull->root, v);
+    if (i.it.valid()) {
+        i.onLower = true;
+        return i;
     }
-    if (upper.empty()){
-        return lower;
+    i.it = ConcatenableQueue::Iterator::find(root->upper_hull->root, v);
+    return i;
+}
+
+TTree::HullIterator::reference TTree::HullIterator::operator*() const {
+    return it.node()->angle.middle;
+}
+
+TTree::HullIterator::pointer TTree::HullIterator::operator->() const {
+    return &it.node()->angle.middle;
+}
+
+TTree::HullIterator &TTree::HullIterator::operator++() {
+    QNode *lower = root->lower_hull->root;
+    if (onLower) {
+        it.next();
+        if (it.valid()) return *this;
+        onLower = false;
+        it = ConcatenableQueue::Iterator::last(root->upper_hull->root);
+        if (it.node()->angle.middle == lower->max->angle.middle) it.prev();
+    } else {
+        it.prev();
     }
-    if (upper.front() == lower.back()) {
-        lower.pop_back();
+    // The leftmost vertex was already visited first, so reaching it again is the end
+    if (it.valid() and it.node()->angle.middle == lower->min->angle.middle) it = ConcatenableQueue::Iterator();
+    return *this;
+}
+
+TTree::HullIterator TTree::HullIterator::operator++(int) {
+    HullIterator old = *this;
+    ++*this;
+    return old;
+}
+
+TTree::HullIterator &TTree::HullIterator::operator--() {
+    QNode *lower = root->lower_hull->root;
+    if (onLower) {
+        it.prev();
+        return *this;
     }
-    if (lower.front() == upper.back()) {
-        upper.pop_back();
+    if (it.valid()) {
+        it.next();
+    } else {
+        // Stepping back from the end
+        it = ConcatenableQueue::Iterator::first(root->upper_hull->root);
+        if (it.node()->angle.middle == lower->min->angle.middle) it.next();
     }
-    lower.insert(lower.end(), upper.begin(), upper.end());
-    return lower;
+    if (not it.valid() or it.node()->angle.middle == lower->max->angle.middle) toLowerLast();
+    return *this;
+}
+
+TTree::HullIterator TTree::HullIterator::operator--(int) {
+    HullIterator old = *this;
+    --*this;
+    return old;
+}
+
+void TTree::HullIterator::toLowerLast() {
+    onLower = true;
+    it = ConcatenableQueue::Iterator::last(root->lower_hull->root);
+}
+
+bool TTree::HullIterator::operator==(const TTree::HullIterator &rhs) const {
+    return onLower == rhs.onLower and it == rhs.it;
+}
+
+bool TTree::HullIterator::operator!=(const TTree::HullIterator &rhs) const {
+    return not (rhs == *this);
+}
+
+TTree::HullView::HullView(TTree::TNode *root) {
+    this->root = root;
+}
+
+TTree::HullIterator TTree::HullView::begin() const {
+    return HullIterator::begin(root);
+}
+
+TTree::HullIterator TTree::HullView::end() const {
+    return HullIterator::end(root);
+}
+
+bool TTree::HullView::empty() const {
+    return root == nullptr;
 }
 
+TTree::HullCursor::HullCursor(TTree::TNode *root) {
+    this->root = root;
+    it = HullIterator::begin(root);
+}
+
+// Starts at the hull vertex start instead of the leftmost one
+TTree::HullCursor::HullCursor(TTree::TNode *root, const Point &start) {
+    this->root = root;
+    it = HullIterator::find(root, start);
+}
+
+const Point &TTree::HullCursor::point() const {
+    return *it;
+}
+
+void TTree::HullCursor::next() {
+    ++it;
+    if (it == HullIterator::end(root)) it = HullIterator::begin(root);
+}
+
+static double pointDistance(const Point &a, const Point &b) {
+    return std::hypot(b.x - a.x, b.y - a.y);
+}
+
+// A hull vertex maximizing the dot product with d, of those the one maximizing the dot product with tieBreak
+static Point extremeVertex(TTree::TNode *root, const Point &d, const Point &tieBreak = Point(0, 0)) {
+    ConcatenableQueue *hull = (d.y > 0 or (d.y == 0 and tieBreak.y > 0)) ? root->upper_hull : root->lower_hull;
+    return hull->findExtreme(d, tieBreak)->angle.middle;
+}
+
+/**
+ * @brief The first vertex counter clockwise of those furthest from the line through the hull edge from a to b
+ * @details The furthest vertices form an edge parallel to a b, walked in the direction from b to a.
+ */
+static Point firstFarthest(TTree::TNode *root, const Point &a, const Point &b) {
+    Point u(b.x - a.x, b.y - a.y);
+    return extremeVertex(root, Point(-u.y, u.x), u);
+}
+
+/**
+ * @brief The largest distance between two hull vertices
+ * @details Rotating calipers over the root hulls in place, O(h) without allocating. For every edge the vertex furthest
+ * from it only moves forward, and the diameter is attained between an edge endpoint and that vertex. The tree keeps
+ * collinear vertices, which tie with the edge, so the walk starts from the furthest vertex of the first edge found by
+ * an extreme point search instead of the end of the edge.
+ */
+double TTree::diameter() {
+    int h = size();
+    if (h < 2) return 0;
+    HullCursor i(root);
+    HullCursor far(root);
+    double diameter = 0;
+    for (int k = 0; k < h; ++k) {
+        HullCursor i1 = i;
+        i1.next();
+        if (k == 0) far = HullCursor(root, firstFarthest(root, i.point(), i1.point()));
+        while (true) {
+            HullCursor far1 = far;
+            far1.next();
+            if (Angle::orientation(i.point(), i1.point(), far1.point()) <=
+                Angle::orientation(i.point(), i1.point(), far.point())) break;
+            far = far1;
+        }
+        diameter = std::max({diameter, pointDistance(i.point(), far.point()), pointDistance(i1.point(), far.point())});
+        i = i1;
+    }
+    return diameter;
+}
+
+/**
+ * @brief The minimum distance between two parallel lines enclosing the hull
+ * @details Rotating calipers over the root hulls in place, O(h) without allocating, started like diameter. The minimum
+ * is attained with one line through a hull edge. Unlike width(Direction) there is no sublinear search for it since the
+ * width is not unimodal in the direction.
+ */
+double TTree::width() {
+    int h = size();
+    if (h < 3) return 0;
+    HullCursor i(root);
+    HullCursor far(root);
+    double width = std::numeric_limits<double>::infinity();
+    for (int k = 0; k < h; ++k) {
+        HullCursor i1 = i;
+        i1.next();
+        if (k == 0) far = HullCursor(root, firstFarthest(root, i.point(), i1.point()));
+        while (true) {
+            HullCursor far1 = far;
+            far1.next();
+            if (Angle::orientation(i.point(), i1.point(), far1.point()) <=
+                Angle::orientation(i.point(), i1.point(), far.point())) break;
+            far = far1;
+        }
+        double height = Angle::orientation(i.point(), i1.point(), far.point()) / pointDistance(i.point(), i1.point());
+        width = std::min(width, height);
+        i = i1;
+    }
+    return width;
+}
+
+/**
+ * @brief The extent of the hull along d, O(log h) with two extreme point searches
+ */
+double TTree::width(Direction d) {
+    if (root == nullptr) return 0;
+    Point high = *extreme(d);
+    Point low = *extreme(Direction(-d.x, -d.y));
+    return (d.x * (high.x - low.x) + d.y * (high.y - low.y)) / std::hypot(d.x, d.y);
+}
+
+/**
+ * @brief The enclosing rectangle of minimum area
+ * @details Rotating calipers over the root hulls in place, O(h) without allocating. The optimal rectangle has a side on
+ * a hull edge, so for every edge the furthest vertices forward along the edge, away from the edge and backward along
+ * the edge are advanced and the rectangle they span is measured.
+ */
+Rectangle TTree::minAreaRectangle() {
+    Rectangle best{};
+    int h = size();
+    if (h == 0) return best;
+    if (h == 1) {
+        Point p = root->point;
+        return Rectangle{{p, p, p, p}, 0};
+    }
+    auto dot = [](double ux, double uy, const Point &p) { return ux * p.x + uy * p.y; };
+    best.area = std::numeric_limits<double>::infinity();
+    HullCursor i(root);
+    HullCursor right(root);
+    HullCursor top(root);
+    HullCursor left(root);
+    for (int k = 0; k < h; ++k) {
+        HullCursor i1 = i;
+        i1.next();
+        double length = pointDistance(i.point(), i1.point());
+        double ux = (i1.point().x - i.point().x) / length;
+        double uy = (i1.point().y - i.point().y) / length;
+        // The normal points into the hull since the walk is counter clockwise
+        double nx = -uy;
+        double ny = ux;
+        // The first edge starts every cursor at the first of its extreme vertices counter clockwise, the end of the
+        // edge can tie with collinear vertices after it
+        if (k == 0) {
+            Point u(i1.point().x - i.point().x, i1.point().y - i.point().y);
+            Point n(-u.y, u.x);
+            right = HullCursor(root, extremeVertex(root, u, Point(-n.x, -n.y)));
+            top = HullCursor(root, extremeVertex(root, n, u));
+            left = HullCursor(root, extremeVertex(root, Point(-u.x, -u.y), n));
+        }
+        auto advance = [&](HullCursor &c, double dx, double dy) {
+            while (true) {
+                HullCursor c1 = c;
+                c1.next();
+                if (dot(dx, dy, c1.point()) <= dot(dx, dy, c.point())) break;
+                c = c1;
+            }
+        };
+        advance(right, ux, uy);
+        advance(top, nx, ny);
+        advance(left, -ux, -uy);
+        double start = dot(ux, uy, left.point()) - dot(ux, uy, i.point());
+        double end = dot(ux, uy, right.point()) - dot(ux, uy, i.point());
+        double height = dot(nx, ny, top.point()) - dot(nx, ny, i.point());
+        double area = (end - start) * height;
+        if (area < best.area) {
+            const Point &p = i.point();
+            best.area = area;
+            best.corners[0] = Point(p.x + ux * start, p.y + uy * start);
+            best.corners[1] = Point(p.x + ux * end, p.y + uy * end);
+            best.corners[2] = Point(best.corners[1].x + nx * height, best.corners[1].y + ny * height);
+            best.corners[3] = Point(best.corners[0].x + nx * height, best.corners[0].y + ny * height);
+        }
+        i = i1;
+    }
+    return best;
+}
+
+/**
+ * @brief Determines whether p is one of the points stored in the tree, hull vertex or not
+ * @details Follows the left maxima down to a leaf without descending, so no hull is split. Runs in O(log n).
+ */
+bool TTree::hasPoint(Point p) {
+    TNode *n = root;
+    if (n == nullptr) return false;
+    while (not n->isLeaf) n = p <= n->lMax->point ? n->left : n->right;
+    return n->point == p;
+}
+
+// The last vertex of a hull left of x, or at x unless strictly is set, nullptr if there is none
+static QNode *vertexLeftOf(QNode *n, double x, bool strictly) {
+    QNode *found = nullptr;
+    while (n != nullptr) {
+        if (n->angle.middle.x < x or (not strictly and n->angle.middle.x == x)) {
+            found = n;
+            n = n->right;
+        } else {
+            n = n->left;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Determines whether p lies inside or on the boundary of the hull
+ * @param p The query point
+ * @details Searches the root lower and upper hulls for the edge below and above p and performs one orientation test
+ * against each. A hull can end in vertical edges, whose vertices are stored bottom to top, so at their x the lower
+ * hull is bounded by the first vertex at x and the upper hull by the last. Runs in O(log h) and does not allocate.
+ */
+bool TTree::contains(Point p) {
+    if (root == nullptr) return false;
+    QNode *lowerRoot = root->lower_hull->root;
+    QNode *upperRoot = root->upper_hull->root;
+    if (p.x < lowerRoot->min->angle.middle.x or p.x > lowerRoot->max->angle.middle.x) return false;
+    // The edge from the last vertex left of p.x ends at or right of p.x, at its first vertex if it ends at p.x
+    QNode *lower = vertexLeftOf(lowerRoot, p.x, true);
+    bool aboveLower = lower == nullptr ? p.y >= lowerRoot->min->angle.middle.y
+                                       : Angle::turn(lower->angle.middle, lower->angle.right, p) >= 0;
+    QNode *upper = vertexLeftOf(upperRoot, p.x, false);
+    bool belowUpper = upper->angle.middle.x == p.x ? p.y <= upper->angle.middle.y
+                                                   : Angle::turn(upper->angle.middle, upper->angle.right, p) <= 0;
+    return aboveLower and belowUpper;
+}
+/**
+ * @brief Finds the two hull vertices touched by the tangent lines from q
+ * @param q A point outside the hull
+ * @return The vertices where the part of the hull visible from q begins and ends in counter clockwise order, or
+ * nothing if q is inside or on the boundary of the hull.
+ * @details The visible edges of each root hull are found in O(log h) without allocating. Counter clockwise the
+ * boundary is the lower hull, the vertical edge on the right, the upper hull and the vertical edge on the left, where
+ * the vertical edges are missing unless the hulls end at different vertices. Visible edges form a single run around
+ * the boundary, so the runs of the pieces are chained together where they meet.
+ */
+std::optional<std::pair<Point, Point>> TTree::tangents(Point q) {
+    if (root == nullptr) return std::nullopt;
+    ConcatenableQueue *lower = root->lower_hull;
+    ConcatenableQueue *upper = root->upper_hull;
+    const Point &lowerMin = lower->root->min->angle.middle;
+    const Point &lowerMax = lower->root->max->angle.middle;
+    const Point &upperMin = upper->root->min->angle.middle;
+    const Point &upperMax = upper->root->max->angle.middle;
+    auto [lowerFirst, lowerLast] = lower->findVisibleEdges(q);
+    auto [upperFirst, upperLast] = upper->findVisibleEdges(q);
+    struct Run {
+        bool visible = false;
+        Point start{};
+        Point end{};
+        // Whether the run covers the first and last edge of its piece
+        bool fromStart = false;
+        bool toEnd = false;
+    };
+    Run runs[4];
+    bool present[4] = {lowerMin != lowerMax, lowerMax != upperMax, upperMin != upperMax, upperMin != lowerMin};
+    if (lowerFirst != nullptr) {
+        runs[0] = {true, lowerFirst->angle.middle, lowerLast->angle.right, lowerFirst->angle.middle == lowerMin,
+                   lowerLast->angle.right == lowerMax};
+    }
+    runs[1] = {present[1] and q.x > lowerMax.x, lowerMax, upperMax, true, true};
+    // The upper hull is stored left to right, so counter clockwise its run goes from upperLast to upperFirst
+    if (upperFirst != nullptr) {
+        runs[2] = {true, upperLast->angle.right, upperFirst->angle.middle, upperLast->angle.right == upperMax,
+                   upperFirst->angle.middle == upperMin};
+    }
+    runs[3] = {present[3] and q.x < lowerMin.x, upperMin, lowerMin, true, true};
+    auto step = [&](int i, int d) {
+        do { i = (i + d + 4) % 4; } while (not present[i]);
+        return i;
+    };
+    auto continues = [&](int i, int j) {
+        return runs[i].visible and runs[j].visible and runs[i].toEnd and runs[j].fromStart;
+    };
+    for (int first = 0; first < 4; ++first) {
+        if (not runs[first].visible or continues(step(first, -1), first)) continue;
+        int last = first;
+        while (step(last, 1) != first and continues(last, step(last, 1))) last = step(last, 1);
+        return std::make_pair(runs[first].start, runs[last].end);
+    }
+    if (root->isLeaf and q != root->point) return std::make_pair(root->point, root->point);
+    return std::nullopt;
+}
+
+/**
+ * @brief Finds a hull vertex maximizing the dot product with d
+ * @param d The direction to maximize in
+ * @return A maximizing vertex, or nothing if the tree is empty
+ * @details Directions pointing up are maximized on the upper hull and all others on the lower hull, O(log h).
+ */
+std::optional<Point> TTree::extreme(Direction d) {
+    if (root == nullptr) return std::nullopt;
+    return extremeVertex(root, d);
+}
+
+/**
+ * @brief Finds a maximizing hull vertex for every direction
+ * @param directions The directions to maximize in
+ * @return The maximizing vertices in the same order as directions, empty if the tree is empty
+ * @details The directions are sorted by angle and swept once around the hull, since the maximizing vertex only moves
+ * counter clockwise as the direction does. The sweep starts at the vertex of the first direction and walks the root
+ * hulls in place, which costs O(h + k log k) rather than O(k log h) and pays off once there are about as many
+ * directions as hull vertices. Otherwise each direction is searched separately, which size() decides in O(1).
+ */
+std::vector<Point> TTree::extreme(const std::vector<Direction> &directions) {
+    std::vector<Point> result;
+    if (root == nullptr) return result;
+    result.resize(directions.size());
+    std::size_t h = size();
+    if (h < 3 or directions.size() < h) {
+        for (std::size_t i = 0; i < directions.size(); ++i) {
+            result[i] = extremeVertex(root, directions[i]);
+        }
+        return result;
+    }
+    std::vector<std::size_t> order(directions.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::vector<double> angles(directions.size());
+    for (std::size_t i = 0; i < directions.size(); ++i) angles[i] = std::atan2(directions[i].y, directions[i].x);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return angles[a] < angles[b]; });
+
+    auto dot = [](const Direction &d, const Point &p) { return d.x * p.x + d.y * p.y; };
+    HullCursor cursor(root, extremeVertex(root, directions[order[0]]));
+    for (std::size_t i: order) {
+        const Direction &d = directions[i];
+        while (true) {
+            HullCursor ahead = cursor;
+            ahead.next();
+            if (dot(d, ahead.point()) <= dot(d, cursor.point())) break;
+            cursor = ahead;
+        }
+        result[i] = cursor.point();
+    }
+    return result;
+}
+/**
+ * @brief Finds where a line crosses the hull boundary
+ * @param line The line to intersect with the hull
+ * @return The 0, 1 or 2 crossing points in the order they are found, a line running along a hull edge crosses at the
+ * edge's endpoints
+ * @details Both root hulls are searched in place by ConcatenableQueue::findCrossingEdges, O(log h).
+ */
+HullCrossings TTree::intersect(Line line) {
+    HullCrossings result;
+    if (root == nullptr) return result;
+    auto add = [&](Point point, Point edgeStart, Point edgeEnd) {
+        // The shared end vertices of the two hulls and vertices on the line are found more than once
+        for (int j = 0; j < result.count; ++j) {
+            if (result.crossings[j].point == point) return;
+        }
+        if (result.count < 2) result.crossings[result.count++] = Crossing{point, edgeStart, edgeEnd};
+    };
+    for (ConcatenableQueue *hull: {root->lower_hull, root->upper_hull}) {
+        QNode *edges[3];
+        int count = hull->findCrossingEdges(line.a, line.b, edges);
+        for (int i = 0; i < count; ++i) {
+            Angle &a = edges[i]->angle;
+            if (std::isinf(a.right.y)) {
+                add(a.middle, a.middle, a.middle);
+                continue;
+            }
+            double startSide = Angle::orientation(line.a, line.b, a.middle);
+            double endSide = Angle::orientation(line.a, line.b, a.right);
+            if (startSide == 0 and endSide == 0) {
+                // The line runs along the edge
+                add(a.middle, a.middle, a.right);
+                add(a.right, a.middle, a.right);
+            } else {
+                double t = startSide / (startSide - endSide);
+                add(Point(a.middle.x + t * (a.right.x - a.middle.x), a.middle.y + t * (a.right.y - a.middle.y)),
+                    a.middle, a.right);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Finds where a segment crosses the hull boundary
+ * @return The crossings of the segment's line that lie on the segment. A segment strictly inside the hull has none, use
+ * contains on an endpoint to tell it apart from a segment that misses the hull.
+ */
+HullCrossings TTree::intersect(Segment segment) {
+    HullCrossings onLine = intersect(Line{segment.a, segment.b});
+    HullCrossings result;
+    double dx = segment.b.x - segment.a.x;
+    double dy = segment.b.y - segment.a.y;
+    double length = dx * dx + dy * dy;
+    for (int i = 0; i < onLine.count; ++i) {
+        Point &p = onLine.crossings[i].point;
+        double t = (p.x - segment.a.x) * dx + (p.y - segment.a.y) * dy;
+        if (0 <= t and t <= length) result.crossings[result.count++] = onLine.crossings[i];
+    }
+    return result;
+}
+
+/**
+ * @brief Intersects every segment with the hull
+ * @details The bounding box of the hull is computed once so segments far from the hull are rejected without searching
+ * the hull trees.
+ */
+std::vector<HullCrossings> TTree::intersect(const std::vector<Segment> &segments) {
+    std::vector<HullCrossings> result(segments.size());
+    if (root == nullptr) return result;
+    double minX = extreme(Direction(-1, 0))->x;
+    double maxX = extreme(Direction(1, 0))->x;
+    double minY = extreme(Direction(0, -1))->y;
+    double maxY = extreme(Direction(0, 1))->y;
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        const Segment &s = segments[i];
+        if (std::max(s.a.x, s.b.x) < minX or std::min(s.a.x, s.b.x) > maxX or
+            std::max(s.a.y, s.b.y) < minY or std::min(s.a.y, s.b.y) > maxY) {
+            continue;
+        }
+        result[i] = intersect(s);
+    }
+    return result;
+}
+
+static double edgeSlope(const Angle &a) {
+    return (a.right.y - a.middle.y) / (a.right.x - a.middle.x);
+}
+
+/**
+ * @brief The height of a hull at x, which must be within its x range
+ * @details A hull can end in a vertical edge, whose vertices are stored bottom to top. The lower hull takes the first
+ * vertex at x and the upper hull the last.
+ */
+static double heightAt(QNode *root, double x, bool lower) {
+    QNode *n = vertexLeftOf(root, x, lower);
+    if (n == nullptr) return root->min->angle.middle.y;
+    const Angle &a = n->angle;
+    if (a.middle.x == x or std::isinf(a.right.y)) return a.middle.y;
+    if (a.right.x == x) return a.right.y;
+    return a.middle.y + edgeSlope(a) * (x - a.middle.x);
+}
+
+// The largest magnitude heightAt combines at x, its rounding error is relative to this
+static double heightScale(QNode *root, double x, bool lower) {
+    QNode *n = vertexLeftOf(root, x, lower);
+    if (n == nullptr) return std::abs(root->min->angle.middle.y);
+    const Angle &a = n->angle;
+    if (std::isinf(a.right.y)) return std::abs(a.middle.y);
+    return std::max(std::abs(a.middle.y), std::abs(a.right.y));
+}
+
+// The slope of a hull just right of x, infinite at its right end
+static double rightSlope(QNode *root, double x) {
+    const Angle &a = vertexLeftOf(root, x, false)->angle;
+    return std::isinf(a.right.y) ? std::numeric_limits<double>::infinity() : edgeSlope(a);
+}
+
+// The slope of a hull just left of x, negative infinity at its left end
+static double leftSlope(QNode *root, double x) {
+    QNode *n = vertexLeftOf(root, x, true);
+    return n == nullptr ? -std::numeric_limits<double>::infinity() : edgeSlope(n->angle);
+}
+
+/**
+ * @brief The vertical gap between two hulls over their common x range [xl, xr], the higher lower hull minus the lower
+ * upper hull. It is convex in x and the hulls intersect exactly where it is not positive.
+ */
+struct HullGap {
+    QNode *lower[2];
+    QNode *upper[2];
+    double xl;
+    double xr;
+
+    double at(double x) const {
+        return std::max(heightAt(lower[0], x, true), heightAt(lower[1], x, true)) -
+               std::min(heightAt(upper[0], x, false), heightAt(upper[1], x, false));
+    }
+
+    // Gaps below this are within the rounding error of evaluating the hulls at x and count as touching
+    double tolerance(double x) const {
+        double largest = std::max({heightScale(lower[0], x, true), heightScale(lower[1], x, true),
+                                   heightScale(upper[0], x, false), heightScale(upper[1], x, false)});
+        return 64 * std::numeric_limits<double>::epsilon() * largest;
+    }
+
+    double rightSlopeAt(double x) const {
+        if (x >= xr) return std::numeric_limits<double>::infinity();
+        double l0 = heightAt(lower[0], x, true);
+        double l1 = heightAt(lower[1], x, true);
+        double u0 = heightAt(upper[0], x, false);
+        double u1 = heightAt(upper[1], x, false);
+        double ls0 = rightSlope(lower[0], x);
+        double ls1 = rightSlope(lower[1], x);
+        double us0 = rightSlope(upper[0], x);
+        double us1 = rightSlope(upper[1], x);
+        double lowerSlope = l0 > l1 ? ls0 : l1 > l0 ? ls1 : std::max(ls0, ls1);
+        double upperSlope = u0 < u1 ? us0 : u1 < u0 ? us1 : std::min(us0, us1);
+        return lowerSlope - upperSlope;
+    }
+
+    /**
+     * @brief Finds the minimum of the gap and where it is attained
+     * @details Every hull vertex in the range is a breakpoint, so a binary search over each hull on the sign of the
+     * slope narrows the range down to one where all four hulls are linear. The gap there is linear except where the
+     * two lower or the two upper hulls cross, so the minimum is at one of a handful of candidates. Each step of the
+     * searches evaluates the hulls in O(log h), O(log^2 h) in total.
+     */
+    double minimum(double &xMin) const {
+        double lo = xl;
+        double hi = xr;
+        for (QNode *root: {lower[0], lower[1], upper[0], upper[1]}) {
+            QNode *n = root;
+            while (n != nullptr) {
+                double x = n->angle.middle.x;
+                if (x <= lo) {
+                    n = n->right;
+                } else if (x >= hi) {
+                    n = n->left;
+                } else if (rightSlopeAt(x) >= 0) {
+                    hi = x;
+                    n = n->left;
+                } else {
+                    lo = x;
+                    n = n->right;
+                }
+            }
+        }
+        double candidates[5] = {lo, hi, lo, hi, lo};
+        QNode *pairs[2][2] = {{lower[0], lower[1]}, {upper[0], upper[1]}};
+        for (int i = 0; i < 2; ++i) {
+            double dLo = heightAt(pairs[i][0], lo, i == 0) - heightAt(pairs[i][1], lo, i == 0);
+            double dHi = heightAt(pairs[i][0], hi, i == 0) - heightAt(pairs[i][1], hi, i == 0);
+            if ((dLo < 0 and dHi > 0) or (dLo > 0 and dHi < 0)) {
+                candidates[2 + i] = lo + (hi - lo) * dLo / (dLo - dHi);
+            }
+        }
+        // The gap can be flat between the crossings, where rounding at the crossings themselves may not show a zero
+        candidates[4] = (candidates[2] + candidates[3]) / 2;
+        double minimum = std::numeric_limits<double>::infinity();
+        for (double x: candidates) {
+            double gap = at(x);
+            if (gap < minimum) {
+                minimum = gap;
+                xMin = x;
+            }
+        }
+        return minimum;
+    }
+};
+
+static HullGap hullGap(TTree::TNode *a, TTree::TNode *b) {
+    return HullGap{{a->lower_hull->root, b->lower_hull->root}, {a->upper_hull->root, b->upper_hull->root},
+                   std::max(a->lower_hull->root->min->angle.middle.x, b->lower_hull->root->min->angle.middle.x),
+                   std::min(a->lower_hull->root->max->angle.middle.x, b->lower_hull->root->max->angle.middle.x)};
+}
+
+/**
+ * @brief Determines whether the hulls of two trees share a point, touching up to rounding counts as intersecting
+ * @details Searches the common x range of the root hulls for the smallest vertical gap between them in O(log^2 h),
+ * without copying either hull.
+ */
+bool TTree::intersects(const TTree &a, const TTree &b) {
+    if (a.root == nullptr or b.root == nullptr) return false;
+    HullGap gap = hullGap(a.root, b.root);
+    if (gap.xl > gap.xr) return false;
+    double x;
+    return gap.minimum(x) <= gap.tolerance(x);
+}
+
+static double segmentDistance(const Point &p, const Point &a, const Point &b) {
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    double lengthSquared = dx * dx + dy * dy;
+    double t = lengthSquared == 0 ? 0 : std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared, 0.0, 1.0);
+    return pointDistance(p, Point(a.x + t * dx, a.y + t * dy));
+}
+
+// The vertex of in order rank k in a QNode tree, found from the subtree sizes
+static const Point &vertexAt(QNode *n, int k) {
+    while (true) {
+        int left = n->left == nullptr ? 0 : n->left->size;
+        if (k == left) return n->angle.middle;
+        if (k < left) {
+            n = n->left;
+        } else {
+            k -= left + 1;
+            n = n->right;
+        }
+    }
+}
+
+// The in order rank of v in a QNode tree, -1 if it is not stored
+static int rankOf(QNode *n, const Point &v) {
+    int rank = 0;
+    while (n != nullptr) {
+        int left = n->left == nullptr ? 0 : n->left->size;
+        if (v == n->angle.middle) return rank + left;
+        if (v < n->angle.middle) {
+            n = n->left;
+        } else {
+            rank += left + 1;
+            n = n->right;
+        }
+    }
+    return -1;
+}
+
+// The root hull vertex at position k, modulo the hull size, in the counter clockwise order of HullIterator in O(log h)
+static Point hullVertex(TTree::TNode *root, int k) {
+    QNode *lower = root->lower_hull->root;
+    QNode *upper = root->upper_hull->root;
+    k %= hullSize(root);
+    if (k < lower->size) return vertexAt(lower, k);
+    bool sharedRight = lower->max->angle.middle == upper->max->angle.middle;
+    return vertexAt(upper, upper->size - 1 - sharedRight - (k - lower->size));
+}
+
+// The position of the root hull vertex v in the order of hullVertex
+static int hullPosition(TTree::TNode *root, const Point &v) {
+    QNode *lower = root->lower_hull->root;
+    QNode *upper = root->upper_hull->root;
+    int rank = rankOf(lower, v);
+    if (rank >= 0) return rank;
+    bool sharedRight = lower->max->angle.middle == upper->max->angle.middle;
+    return lower->size + upper->size - 1 - sharedRight - rankOf(upper, v);
+}
+
+/**
+ * @brief Finds the face of the hull of a that holds its point closest to the hull of b
+ * @param u A direction along which b lies strictly ahead of a
+ * @return The ends of the face, equal when it is a single vertex
+ * @details The gap between the hulls along a direction is unimodal over the directions that separate them and largest
+ * along the direction w from a's closest point to b's. Walking counter clockwise from the vertex of a extreme along -u,
+ * the normals of a's edges turn once around from -u, so the edges whose normal comes before w are a prefix of the walk
+ * and a binary search over positions finds the first edge past it. An edge whose normal n separates the hulls comes
+ * before w when the gap grows past n, which is when the vertex of b extreme along -n lies ahead of the edge's end.
+ * Ties go to the vertex the extreme moves to past n, so parallel faces are compared by their nearest ends. The other
+ * edges come before w exactly when they come before u. Each step costs O(log h), O(log^2 h) in total, and every
+ * decision is exact up to the extreme vertex queries.
+ */
+static std::pair<Point, Point> closestFace(TTree::TNode *a, TTree::TNode *b, const Point &u) {
+    int size = hullSize(a);
+    // Ties go to the last of the vertices counter clockwise, so the edge leaving start turns away from -u
+    int start = hullPosition(a, extremeVertex(a, Point(-u.x, -u.y), Point(u.y, -u.x)));
+    int ahead = (hullPosition(a, extremeVertex(a, u, Point(-u.y, u.x))) - start + size) % size;
+    auto beforeClosest = [&](int i) {
+        Point v1 = hullVertex(a, start + i);
+        Point v2 = hullVertex(a, start + i + 1);
+        Point q = extremeVertex(b, Point(v1.y - v2.y, v2.x - v1.x), Point(v1.x - v2.x, v1.y - v2.y));
+        if (Angle::turn(v1, v2, q) >= 0) return i < ahead;
+        return Angle::dotSign(v1, v2, v2, q) > 0;
+    };
+    int lo = 0;
+    int hi = size;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (beforeClosest(mid)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    // When w is the normal of the next edge the face runs to the last vertex extreme along it
+    Point v1 = hullVertex(a, start + lo);
+    Point v2 = hullVertex(a, start + lo + 1);
+    if (v1 == v2) return {v1, v1};
+    return {v1, extremeVertex(a, Point(v2.y - v1.y, v1.x - v2.x), Point(v2.x - v1.x, v2.y - v1.y))};
+}
+
+/**
+ * @brief The smallest distance between the hulls of two trees, 0 if they intersect
+ * @return The distance, or infinity if either tree is empty
+ * @details The vertical gap search gives a direction separating the hulls, from which closestFace finds the vertex or
+ * edge of each hull that holds its closest point, so the distance is the one between those two faces. O(log^2 h)
+ * without copying either hull.
+ */
+double TTree::distance(const TTree &a, const TTree &b) {
+    if (a.root == nullptr or b.root == nullptr) return std::numeric_limits<double>::infinity();
+    HullGap gap = hullGap(a.root, b.root);
+    Point u;
+    if (gap.xl > gap.xr) {
+        u = Point(a.root->lower_hull->root->max->angle.middle.x < gap.xl ? 1 : -1, 0);
+    } else {
+        double x;
+        if (gap.minimum(x) <= gap.tolerance(x)) return 0;
+        // The lower hull of the upper tree and the upper hull of the lower tree have a common tangent slope at x
+        bool bAbove = heightAt(b.root->lower_hull->root, x, true) > heightAt(a.root->upper_hull->root, x, false);
+        TNode *top = bAbove ? b.root : a.root;
+        TNode *bottom = bAbove ? a.root : b.root;
+        QNode *convex = top->lower_hull->root;
+        QNode *concave = bottom->upper_hull->root;
+        // At its ends the concave hull is bounded by every line steeper than its last edge, unlike the convex one
+        double concaveRight = rightSlope(concave, x);
+        double concaveLeft = leftSlope(concave, x);
+        double lo = std::max(leftSlope(convex, x), std::isinf(concaveRight) ? -concaveRight : concaveRight);
+        double hi = std::min(rightSlope(convex, x), std::isinf(concaveLeft) ? -concaveLeft : concaveLeft);
+        double s = lo > hi ? (lo + hi) / 2 : std::clamp(0.0, lo, hi);
+        u = bAbove ? Point(-s, 1) : Point(s, -1);
+    }
+    auto [p0, p1] = closestFace(a.root, b.root, u);
+    auto [q0, q1] = closestFace(b.root, a.root, Point(-u.x, -u.y));
+    return std::min({segmentDistance(p0, q0, q1), segmentDistance(p1, q0, q1), segmentDistance(q0, p0, p1),
+                     segmentDistance(q1, p0, p1)});
+}
+
+/**
+ * @brief The distance from p to the boundary of the hull of a nonempty tree
+ * @param hint An edge near the previous query of the same batch or nullptr, replaced by the nearest edge when p is
+ * inside the hull. It is only valid until the tree is updated.
+ */
+static double boundaryDistance(TTree::TNode *root, const Point &p, QNode *&hint) {
+    ConcatenableQueue *lower = root->lower_hull;
+    ConcatenableQueue *upper = root->upper_hull;
+    const Point &lowerMin = lower->root->min->angle.middle;
+    const Point &lowerMax = lower->root->max->angle.middle;
+    const Point &upperMin = upper->root->min->angle.middle;
+    const Point &upperMax = upper->root->max->angle.middle;
+    double distance = std::numeric_limits<double>::infinity();
+    bool outside = false;
+    for (ConcatenableQueue *hull: {lower, upper}) {
+        auto [first, last] = hull->findVisibleEdges(p);
+        if (first == nullptr) continue;
+        outside = true;
+        distance = std::min(distance, ConcatenableQueue::edgeDistance(hull->findNearestEdge(p, first, last), p));
+    }
+    bool hasLeftEdge = lowerMin != upperMin;
+    bool hasRightEdge = lowerMax != upperMax;
+    if (hasLeftEdge and p.x < lowerMin.x) outside = true;
+    if (hasRightEdge and p.x > lowerMax.x) outside = true;
+    if (hasLeftEdge) distance = std::min(distance, segmentDistance(p, upperMin, lowerMin));
+    if (hasRightEdge) distance = std::min(distance, segmentDistance(p, lowerMax, upperMax));
+    if (outside) return distance;
+    QNode *best = hint;
+    if (hint != nullptr) distance = std::min(distance, ConcatenableQueue::edgeDistance(hint, p));
+    ConcatenableQueue::nearestEdge(lower->root, p, best, distance);
+    ConcatenableQueue::nearestEdge(upper->root, p, best, distance);
+    hint = best;
+    return distance;
+}
+
+/**
+ * @brief The distance from p to the boundary of the hull
+ * @return The distance, or infinity if the tree is empty
+ * @details From outside the nearest point lies on the edges visible from p, which are searched in O(log h) on each
+ * root hull. From inside every edge is a candidate and both root hulls are searched with branch and bound. The
+ * distance to the edges from inside can have a local minimum per pair of opposite edges, as in a rectangle around its
+ * centre, so no descent decides it and an inside query is O(h) in the worst case. On hulls whose vertices are spread
+ * evenly the search typically follows a few paths of O(log h).
+ */
+double TTree::boundaryDistance(Point p) {
+    if (root == nullptr) return std::numeric_limits<double>::infinity();
+    QNode *hint = nullptr;
+    return ::boundaryDistance(root, p, hint);
+}
+
+/**
+ * @brief The distance from each point to the boundary of the hull
+ * @details Queries sorted so that consecutive points are close, for example by x, share work: the nearest edge of one
+ * query bounds the branch and bound search of the next from the start. Each inside query is still O(h) in the worst
+ * case.
+ */
+std::vector<double> TTree::boundaryDistance(const std::vector<Point> &points) {
+    std::vector<double> result;
+    result.reserve(points.size());
+    if (root == nullptr) {
+        result.assign(points.size(), std::numeric_limits<double>::infinity());
+        return result;
+    }
+    QNode *hint = nullptr;
+    for (const Point &p: points) {
+        result.push_back(::boundaryDistance(root, p, hint));
+    }
+    return result;
+}
+
+/**
+ * @brief Finds the hull vertex of a nonempty tree farthest from p
+ * @param hint A vertex far from the previous query of the same batch or nullptr, replaced by the farthest vertex. It
+ * is only valid until the tree is updated.
+ */
+static Point farthest(TTree::TNode *root, const Point &p, QNode *&hint) {
+    QNode *best = hint;
+    double distance = -1;
+    if (hint != nullptr) distance = pointDistance(p, hint->angle.middle);
+    ConcatenableQueue::farthestVertex(root->lower_hull->root, p, best, distance);
+    ConcatenableQueue::farthestVertex(root->upper_hull->root, p, best, distance);
+    hint = best;
+    return best->angle.middle;
+}
+
+/**
+ * @brief Finds the hull vertex farthest from p
+ * @details Both root hulls are searched with branch and bound. The distance from p to the vertices can have several
+ * local maxima around the hull, so no descent decides which is the largest and a query is O(h) in the worst case, as
+ * for a regular polygon seen from near its centre. Typically only a few paths of O(log h) are followed.
+ */
+std::optional<Point> TTree::farthest(Point p) {
+    if (root == nullptr) return std::nullopt;
+    QNode *hint = nullptr;
+    return ::farthest(root, p, hint);
+}
+
+/**
+ * @brief Finds the hull vertex farthest from each point, empty if the tree is empty
+ * @details Like the batched boundaryDistance, each query starts from the answer to the previous one, and each is O(h)
+ * in the worst case.
+ */
+std::vector<Point> TTree::farthest(const std::vector<Point> &points) {
+    std::vector<Point> result;
+    if (root == nullptr) return result;
+    result.reserve(points.size());
+    QNode *hint = nullptr;
+    for (const Point &p: points) {
+        result.push_back(::farthest(root, p, hint));
+    }
+    return result;
+}
 
 void TTree::descend(TTree::TNode *&n) {
     if (n->isLeaf or n->lower_hull->root == nullptr) {
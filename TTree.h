@@ -11,6 +11,25 @@
 #define DYNAMICCONVEXHULL_TTREE_H
 #include "Point.h"
 #include "ConcatenableQueue.h"
+#include "Line.h"
+#include <functional>
+#include <iterator>
+#include <optional>
+
+// A direction for extreme point queries, only the vector from the origin to the point matters
+using Direction = Point;
+
+// A rectangle given by its corners in counter clockwise order
+struct Rectangle {
+    Point corners[4];
+    double area;
+};
+
+// The vertices that entered and left the hull in one update, each a contiguous chain in counter clockwise order
+struct HullDelta {
+    std::vector<Point> entered;
+    std::vector<Point> left;
+};
 
 class TTree {
 public:
@@ -28,9 +47,10 @@ public:
         TNode *rMin{};
 
 
-        TNode(Point p, TNode *par);
+        TNode(Point p, TNode *par, bool integral);
         TNode(TNode* par, TNode *l, TNode *r);
         TNode() = default;
+        ~TNode();
 
         bool operator<(const TNode &rhs) const;
 
@@ -41,9 +61,97 @@ public:
         bool operator>=(const TNode &rhs) const;
 
     };
+    /**
+     * @brief A bidirectional iterator over the root hull in counter clockwise order from its leftmost vertex, the lower
+     * hull left to right and then the upper hull right to left. Vertices shared by both hulls are visited once.
+     * @details Keeps the path to the current hull node on the stack, so iterating never allocates. The iterator is
+     * invalidated by any update of the tree.
+     */
+    class HullIterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Point;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Point *;
+        using reference = const Point &;
+
+        HullIterator() = default;
+
+        static HullIterator begin(TNode *root);
+
+        static HullIterator end(TNode *root);
+
+        static HullIterator find(TNode *root, const Point &v);
+
+        reference operator*() const;
+
+        pointer operator->() const;
+
+        HullIterator &operator++();
+
+        HullIterator operator++(int);
+
+        HullIterator &operator--();
+
+        HullIterator operator--(int);
+
+        bool operator==(const HullIterator &rhs) const;
+
+        bool operator!=(const HullIterator &rhs) const;
+
+    private:
+        TNode *root{};
+        bool onLower = false;
+        ConcatenableQueue::Iterator it;
+
+        void toLowerLast();
+    };
+
+    /**
+     * @brief The root hull as a range of HullIterators, a cheap handle that does not copy any vertices
+     */
+    class HullView {
+    public:
+        explicit HullView(TNode *root);
+
+        HullIterator begin() const;
+
+        HullIterator end() const;
+
+        bool empty() const;
+
+    private:
+        TNode *root;
+    };
+
+    /**
+     * @brief Walks the root hull in the same order as HullIterator, but wraps around forever
+     */
+    class HullCursor {
+    public:
+        explicit HullCursor(TNode *root);
+
+        HullCursor(TNode *root, const Point &start);
+
+        const Point &point() const;
+
+        void next();
+
+    private:
+        TNode *root;
+        HullIterator it;
+    };
+
     static const bool RED = false;
     static const bool BLACK = true;
     TNode *root;
+    // Whether every point has 32 bit integer coordinates, so that the hulls are merged with exact integer predicates
+    bool integral = false;
+    // Called in order after every insert or remove that changes the hull, each under the handle it was added with. The
+    // delta is reused between calls.
+    std::vector<std::pair<int, std::function<void(const HullDelta &)>>> hullObservers;
+    int nextObserver = 0;
+    HullDelta delta;
     
     virtual void ascend(TNode *&n);
     virtual void descend(TNode *&n);
@@ -64,19 +172,94 @@ public:
     
     void recycle(TNode *n);
 
+    /**
+     * @brief Splits the subtree rooted at T into a tree of leaves that belong to the left and a tree of leaves that
+     * belong to the right. Every internal node on the search path is descended and reused as the middle node of a join.
+     * @param T - The tree to split, detached from any parent
+     * @param belongsToRight - A function that takes a point and returns true if the point belongs to the right tree.
+     * @return The roots of the left and right trees created by the division, either may be nullptr.
+     */
+    template<typename Functor>
+    std::pair<TNode *, TNode *> split(TNode *T, Functor belongsToRight) {
+        if (T == nullptr) {
+            return {nullptr, nullptr};
+        }
+        T->parent = nullptr;
+        if (T->isLeaf) {
+            if (belongsToRight(T->point)) {
+                return {nullptr, T};
+            }
+            return {T, nullptr};
+        }
+        descend(T);
+        TNode *l = T->left;
+        TNode *r = T->right;
+        l->parent = nullptr;
+        r->parent = nullptr;
+        if (belongsToRight(T->lMax->point)) {
+            // The division point is in the left subtree, so everything in r belongs to the right tree
+            auto [L, lr] = split(l, belongsToRight);
+            return {L, join(lr, T, r)};
+        } else {
+            auto [rl, R] = split(r, belongsToRight);
+            return {join(l, T, rl), R};
+        }
+    }
+
+    TNode *join(TNode *T1, TNode *k, TNode *T2);
+    TNode *join2(TNode *T1, TNode *T2);
+    TNode *joinRight(TNode *T1, TNode *k, TNode *T2, int t1BlackHeight, int t2BlackHeight);
+    TNode *joinLeft(TNode *T1, TNode *k, TNode *T2, int t1BlackHeight, int t2BlackHeight);
+    void link(TNode *k, TNode *l, TNode *r);
+    static int blackHeight(TNode *n);
+    void collectChain(const Point &from, const Point &to, std::vector<Point> &chain);
+    void notifyHullObservers();
+
 
 
     TTree();
+    explicit TTree(bool integral);
+    TTree(const TTree &) = delete;
+    TTree(TTree &&other) noexcept;
+    TTree &operator=(TTree &&other) noexcept;
     ~TTree();
     virtual bool insert(Point p);
     bool insert(double x, double y);
     virtual bool remove(Point p);
+    bool removeRange(double xLo, double xHi);
+    TTree splitAt(double x);
+    void concatenate(TTree &&right);
+    std::vector<Point> hullInRange(double xLo, double xHi);
+    int addHullObserver(std::function<void(const HullDelta &)> observer);
+    bool removeHullObserver(int handle);
     void displayTree();
     void checkProperties();
     void printLowerHull();
     std::vector<Point> getLowerHull();
     std::vector<Point> getUpperHull();
     std::vector<Point> getHull();
+    HullView hull();
+    bool contains(Point p);
+    bool hasPoint(Point p);
+    int size();
+    double area();
+    double perimeter();
+    double diameter();
+    double width();
+    double width(Direction d);
+    Rectangle minAreaRectangle();
+    std::optional<std::pair<Point, Point>> tangents(Point q);
+    std::optional<Point> extreme(Direction d);
+    std::vector<Point> extreme(const std::vector<Direction> &directions);
+    HullCrossings intersect(Line line);
+    HullCrossings intersect(Segment segment);
+    std::vector<HullCrossings> intersect(const std::vector<Segment> &segments);
+    static bool intersects(const TTree &a, const TTree &b);
+    static double distance(const TTree &a, const TTree &b);
+    double boundaryDistance(Point p);
+    std::vector<double> boundaryDistance(const std::vector<Point> &points);
+    std::optional<Point> farthest(Point p);
+    std::vector<Point> farthest(const std::vector<Point> &points);
 };
 
 
@@ -0,0 +1,146 @@
+/**
+ * @file UpdateService.cpp
+ * @date 10/19/26
+ * @details Producers push requests onto a lock free stack with one compare and swap, and the writer takes the whole
+ * stack with one exchange, which makes everything queued since the last batch the next batch. Within a batch only the
+ * net effect on each point reaches the tree: the requests on a point are answered by replaying them from whether the
+ * tree holds the point, so an insert and remove of the same point cancel and cost no hull update at all. The futures
+ * of a batch become ready after the batch is applied and the afterBatch callback, for example a publish, has run, so
+ * an update is visible to anyone reading the published hull once its future is ready.
+ */
+
+#include "UpdateService.h"
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+// The histogram bucket of v, the position of its highest set bit
+static int bucketOf(std::uint64_t v) {
+    int bucket = 0;
+    while (bucket + 1 < UpdateService::BUCKETS and (v >> (bucket + 1)) != 0) bucket++;
+    return bucket;
+}
+
+/**
+ * @brief Starts the writer thread, which from now on is the only thread that may touch the tree
+ * @param afterBatch Called on the writer thread after each batch is applied and before its futures become ready
+ */
+UpdateService::UpdateService(TTree &tree, std::function<void()> afterBatch)
+        : tree(tree), afterBatch(std::move(afterBatch)), writer([this]() { run(); }) {}
+
+/**
+ * @brief Applies every update submitted so far and stops the writer thread
+ */
+UpdateService::~UpdateService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+/**
+ * @brief Queues an insert of p, can be called from any thread
+ * @return A future holding what TTree::insert returns, ready once the point is in the tree
+ */
+std::future<bool> UpdateService::insert(Point p) {
+    return submit(p, true);
+}
+
+/**
+ * @brief Queues a remove of p, can be called from any thread
+ * @return A future holding what TTree::remove returns, ready once the point is gone from the tree
+ */
+std::future<bool> UpdateService::remove(Point p) {
+    return submit(p, false);
+}
+
+std::future<bool> UpdateService::submit(Point p, bool insert) {
+    auto *request = new Request{p, insert, Clock::now(), std::promise<bool>(), nullptr};
+    std::future<bool> result = request->done.get_future();
+    depth.fetch_add(1);
+    request->next = head.load();
+    while (not head.compare_exchange_weak(request->next, request)) {}
+    // Sequentially consistent, so either the writer sees the request before sleeping or this sees it sleeping
+    if (sleeping.load()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake.notify_one();
+    }
+    return result;
+}
+
+/**
+ * @brief A copy of the counters, safe to call from any thread
+ */
+UpdateService::Metrics UpdateService::metrics() {
+    std::lock_guard<std::mutex> lock(countersMutex);
+    Metrics copy = counters;
+    copy.queueDepth = depth.load();
+    return copy;
+}
+
+void UpdateService::run() {
+    std::vector<Request *> batch;
+    while (true) {
+        Request *taken = head.exchange(nullptr);
+        if (taken == nullptr) {
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping.store(true);
+            wake.wait(lock, [this]() { return head.load() != nullptr or stopping; });
+            sleeping.store(false);
+            if (head.load() == nullptr) return;
+            continue;
+        }
+        batch.clear();
+        for (Request *r = taken; r != nullptr; r = r->next) batch.push_back(r);
+        std::reverse(batch.begin(), batch.end());
+        depth.fetch_sub(batch.size());
+        apply(batch);
+    }
+}
+
+/**
+ * @brief Applies a batch in submission order up to reordering updates of different points, which commute
+ */
+void UpdateService::apply(std::vector<Request *> &batch) {
+    std::stable_sort(batch.begin(), batch.end(), [](const Request *a, const Request *b) { return a->point < b->point; });
+    std::vector<bool> results(batch.size());
+    std::uint64_t applied = 0;
+    std::int64_t pointChange = 0;
+    for (std::size_t i = 0; i < batch.size();) {
+        Point p = batch[i]->point;
+        bool initial = tree.hasPoint(p);
+        bool present = initial;
+        for (; i < batch.size() and batch[i]->point == p; i++) {
+            results[i] = batch[i]->insert != present;
+            present = batch[i]->insert;
+        }
+        if (present != initial) {
+            if (present) {
+                tree.insert(p);
+            } else {
+                tree.remove(p);
+            }
+            applied++;
+            pointChange += present ? 1 : -1;
+        }
+    }
+    if (afterBatch) afterBatch();
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(countersMutex);
+    counters.batches++;
+    counters.updates += batch.size();
+    counters.applied += applied;
+    counters.pointChange += pointChange;
+    counters.batchSizes[bucketOf(batch.size())]++;
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        auto latency = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - batch[i]->submitted).count());
+        counters.latencies[bucketOf(latency)]++;
+        counters.totalLatency += latency;
+        counters.maxLatency = std::max(counters.maxLatency, latency);
+        batch[i]->done.set_value(results[i]);
+        delete batch[i];
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file UpdateService.h
+ * @brief Accepts inserts and removes from any number of threads and applies them to a TTree on one writer thread.
+ * @date 10/19/26
+ */
+
+#ifndef DYNAMICCONVEXHULL_UPDATESERVICE_H
+#define DYNAMICCONVEXHULL_UPDATESERVICE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include "TTree.h"
+
+class UpdateService {
+public:
+    static const int BUCKETS = 32;
+
+    /**
+     * @brief Counters of the service, histograms have one bucket per power of two, bucket i counting values in
+     * [2^i, 2^(i+1)) and bucket 0 also counting 0
+     */
+    struct Metrics {
+        // Updates submitted but not yet taken by the writer
+        std::size_t queueDepth = 0;
+        std::uint64_t batches = 0;
+        std::uint64_t updates = 0;
+        // Inserts and removes that reached the tree after coalescing
+        std::uint64_t applied = 0;
+        // Points inserted minus points removed by the applied updates
+        std::int64_t pointChange = 0;
+        std::array<std::uint64_t, BUCKETS> batchSizes{};
+        // Nanoseconds from submitting an update to its future becoming ready
+        std::array<std::uint64_t, BUCKETS> latencies{};
+        std::uint64_t totalLatency = 0;
+        std::uint64_t maxLatency = 0;
+    };
+
+    explicit UpdateService(TTree &tree, std::function<void()> afterBatch = nullptr);
+
+    UpdateService(const UpdateService &) = delete;
+
+    UpdateService &operator=(const UpdateService &) = delete;
+
+    ~UpdateService();
+
+    std::future<bool> insert(Point p);
+
+    std::future<bool> remove(Point p);
+
+    Metrics metrics();
+
+private:
+    // A submitted update, linked into the queue by the thread that submitted it
+    struct Request {
+        Point point;
+        bool insert;
+        std::chrono::steady_clock::time_point submitted;
+        std::promise<bool> done;
+        Request *next;
+    };
+
+    TTree &tree;
+    std::function<void()> afterBatch;
+    // The newest request, the queue is a lock free stack that the writer takes whole
+    std::atomic<Request *> head{nullptr};
+    std::atomic<std::size_t> depth{0};
+    // Only used to put the writer to sleep when the queue is empty
+    std::atomic<bool> sleeping{false};
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    Metrics counters;
+    std::mutex countersMutex;
+    std::thread writer;
+
+    std::future<bool> submit(Point p, bool insert);
+
+    void run();
+
+    void apply(std::vector<Request *> &batch);
+};
+
+
+#endif //DYNAMICCONVEXHULL_UPDATESERVICE_H
@@ -2,13 +2,23 @@
 #include <cassert>
 using namespace std;
 
+/**
+ * @brief Streams the root hull of t to the window, hull keeps its capacity across frames and only records the drawn
+ * vertices for deleteHull
+ */
 void VisUtils::drawHull(TTree *t, vector<Point> &hull) {
-    hull = t->getHull();
-    if (hull.size() < 2) return;
-    for (int i = 0; i < hull.size() - 1; ++i) {
-        w->draw_segment(hull[i].x, hull[i].y, hull[i + 1].x, hull[i + 1].y);
+    hull.clear();
+    TTree::HullView view = t->hull();
+    if (view.empty()) return;
+    const Point &first = *view.begin();
+    const Point *prev = nullptr;
+    for (const Point &p: view) {
+        if (prev != nullptr) w->draw_segment(prev->x, prev->y, p.x, p.y);
+        hull.push_back(p);
+        prev = &p;
     }
-    w->draw_segment(hull[0].x, hull[0].y, hull[hull.size() - 1].x, hull[hull.size() - 1].y);
+    if (hull.size() < 2) return;
+    w->draw_segment(first.x, first.y, prev->x, prev->y);
 }
 
 void VisUtils::deleteHull(vector<Point> &hull) {
@@ -5,8 +5,70 @@
 #include <vector>
 #include <random>
 #include "timer.h"
-int main() {
+#include "HullSnapshot.h"
+#include "LineEnvelope.h"
+#include "HalfPlaneSet.h"
+#include "PersistentHull.h"
+#include "SnapshotPublisher.h"
+#include "UpdateService.h"
+#include "ShardedHull.h"
+#include "ParallelTTree.h"
+#include "SplitTTree.h"
+#include "HullMap.h"
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cmath>
+int main(int argc, char **argv) {
     timer t;
+    if (argc > 1 and std::string(argv[1]) == "contains") {
+        t.containsTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "envelope") {
+        t.envelopeTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "halfplanes") {
+        t.halfPlaneTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "updates") {
+        t.updateServiceTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "integer") {
+        t.integerTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "predicates") {
+        t.predicateTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "grid") {
+        t.gridTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "hullmap") {
+        t.hullMapTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "chains") {
+        t.chainTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "shards") {
+        t.shardTest();
+        return 0;
+    }
+    if (argc > 1 and std::string(argv[1]) == "publish") {
+        t.publishTest();
+        return 0;
+    }
     t.addTest();
     return 0;
 }
@@ -35,3 +97,673 @@ void timer::addTest() {
         std::cout << "(" << pow(i + 1, 2)  << "," << 1000000 * duration / CLOCKS_PER_SEC << ")" << std::endl;
     }
 }
+
+void timer::containsTest() {
+    TTree tree;
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> dis(-1000, 1000);
+    for (int i = 0; i < (1 << 16); i++) {
+        tree.insert(dis(gen), dis(gen));
+    }
+    int queries = 1 << 22;
+    std::vector<double> xs(queries);
+    std::vector<double> ys(queries);
+    for (int i = 0; i < queries; i++) {
+        xs[i] = dis(gen);
+        ys[i] = dis(gen);
+    }
+    std::vector<std::uint8_t> inside(queries);
+    HullSnapshot snapshot(tree);
+    auto time = [&](const char *name, auto classify) {
+        auto start = std::chrono::steady_clock::now();
+        classify();
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << name << ": " << queries / seconds / 1e6 << " million points per second" << std::endl;
+    };
+    time("TTree::contains", [&]() {
+        for (int i = 0; i < queries; i++) inside[i] = tree.contains(Point(xs[i], ys[i]));
+    });
+    time("HullSnapshot::classifyScalar", [&]() { snapshot.classifyScalar(xs.data(), ys.data(), queries, inside.data()); });
+    time("HullSnapshot::classify", [&]() { snapshot.classify(xs.data(), ys.data(), queries, inside.data()); });
+    std::sort(xs.begin(), xs.end());
+    time("HullSnapshot::classify (sorted)", [&]() { snapshot.classify(xs.data(), ys.data(), queries, inside.data()); });
+}
+
+/**
+ * @brief A Li Chao tree over a fixed set of query coordinates, the usual baseline for maximum of lines queries.
+ * @details Every node keeps the line that wins at the middle of its range, so insert and evaluate both walk a single
+ * root to leaf path. Lines cannot be removed.
+ */
+class LiChaoTree {
+public:
+    struct Line {
+        double slope;
+        double intercept;
+
+        double at(double x) const { return slope * x + intercept; }
+    };
+
+    std::vector<double> xs;
+    std::vector<Line> lines;
+    std::vector<bool> used;
+
+    explicit LiChaoTree(std::vector<double> coordinates) : xs(std::move(coordinates)) {
+        std::sort(xs.begin(), xs.end());
+        xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+        lines.resize(4 * xs.size());
+        used.resize(4 * xs.size());
+    }
+
+    void insert(Line line) {
+        std::size_t node = 1;
+        std::size_t lo = 0;
+        std::size_t hi = xs.size() - 1;
+        while (true) {
+            if (not used[node]) {
+                lines[node] = line;
+                used[node] = true;
+                return;
+            }
+            std::size_t mid = (lo + hi) / 2;
+            if (line.at(xs[mid]) > lines[node].at(xs[mid])) std::swap(line, lines[node]);
+            if (lo == hi) return;
+            // The losing line can only win on the side where it beats the winner at an end point
+            if (line.at(xs[lo]) > lines[node].at(xs[lo])) {
+                node = 2 * node;
+                hi = mid;
+            } else if (line.at(xs[hi]) > lines[node].at(xs[hi])) {
+                node = 2 * node + 1;
+                lo = mid + 1;
+            } else {
+                return;
+            }
+        }
+    }
+
+    // x must be one of the coordinates the tree was built with
+    double maximum(double x) const {
+        double best = -std::numeric_limits<double>::infinity();
+        std::size_t node = 1;
+        std::size_t lo = 0;
+        std::size_t hi = xs.size() - 1;
+        std::size_t i = std::lower_bound(xs.begin(), xs.end(), x) - xs.begin();
+        while (used[node]) {
+            best = std::max(best, lines[node].at(x));
+            if (lo == hi) break;
+            std::size_t mid = (lo + hi) / 2;
+            if (i <= mid) {
+                node = 2 * node;
+                hi = mid;
+            } else {
+                node = 2 * node + 1;
+                lo = mid + 1;
+            }
+        }
+        return best;
+    }
+};
+
+void timer::envelopeTest() {
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> dis(-1000, 1000);
+    int count = 1 << 16;
+    int queries = 1 << 20;
+    std::vector<LiChaoTree::Line> lines(count);
+    for (auto &line: lines) line = {dis(gen), dis(gen)};
+    std::vector<double> xs(queries);
+    for (double &x: xs) x = dis(gen);
+    LineEnvelope envelope;
+    LiChaoTree liChao(xs);
+    double checksum = 0;
+    auto time = [&](const char *name, int operations, auto run) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << name << ": " << 1e9 * seconds / operations << " ns per operation" << std::endl;
+    };
+    time("LineEnvelope::insert", count, [&]() {
+        for (auto &line: lines) envelope.insert(line.slope, line.intercept);
+    });
+    time("LiChaoTree::insert", count, [&]() {
+        for (auto &line: lines) liChao.insert(line);
+    });
+    time("LineEnvelope::maximum", queries, [&]() {
+        for (double x: xs) checksum += *envelope.maximum(x);
+    });
+    time("LiChaoTree::maximum", queries, [&]() {
+        for (double x: xs) checksum -= liChao.maximum(x);
+    });
+    // Only the envelope can drop lines, the Li Chao tree would have to be rebuilt
+    time("LineEnvelope::remove", count / 2, [&]() {
+        for (int i = 0; i < count / 2; i++) envelope.remove(lines[i].slope, lines[i].intercept);
+    });
+    std::cout << "checksum: " << checksum << std::endl;
+}
+
+/**
+ * @brief Times HalfPlaneSet updates and queries on half-planes tangent to a circle, whose intersection is a polygon
+ * close to the disk.
+ * @details Every other query runs after a constraint has been swapped for another, so the queries see a changing set.
+ */
+void timer::halfPlaneTest() {
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> angle(0, 6.283185307179586);
+    std::uniform_real_distribution<> jitter(0, 1);
+    int count = 1 << 16;
+    int queries = 1 << 16;
+    std::vector<HalfPlane> halfPlanes(count);
+    for (auto &h: halfPlanes) {
+        double t = angle(gen);
+        h = {std::cos(t), std::sin(t), 1000 + jitter(gen)};
+    }
+    std::vector<Direction> objectives(queries);
+    for (auto &d: objectives) {
+        double t = angle(gen);
+        d = Direction(std::cos(t), std::sin(t));
+    }
+    HalfPlaneSet set;
+    double checksum = 0;
+    auto time = [&](const char *name, int operations, auto run) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << name << ": " << 1e9 * seconds / operations << " ns per operation" << std::endl;
+    };
+    time("HalfPlaneSet::insert", count, [&]() {
+        for (auto &h: halfPlanes) set.insert(h);
+    });
+    time("HalfPlaneSet::isFeasible", queries, [&]() {
+        for (int i = 0; i < queries; i++) checksum += set.isFeasible();
+    });
+    time("HalfPlaneSet::optimize", queries, [&]() {
+        for (auto &d: objectives) {
+            HalfPlaneSet::Optimum optimum = set.optimize(d);
+            if (optimum.status == HalfPlaneSet::Optimal) checksum += optimum.point.x + optimum.point.y;
+        }
+    });
+    time("HalfPlaneSet::remove and insert", queries, [&]() {
+        for (int i = 0; i < queries; i++) {
+            HalfPlane &h = halfPlanes[i % count];
+            set.remove(h);
+            if (i % 2 == 1) checksum += set.isFeasible();
+            set.insert(h);
+        }
+    });
+    time("HalfPlaneSet::remove", count / 2, [&]() {
+        for (int i = 0; i < count / 2; i++) set.remove(halfPlanes[i]);
+    });
+    std::cout << "checksum: " << checksum << std::endl;
+}
+
+/**
+ * @brief Measures how reader throughput scales with the number of reader threads while one writer keeps updating the
+ * hull, for both ways of sharing it with readers.
+ * @details The writer inserts and removes points near the hull so that most updates change it and are published.
+ */
+void timer::publishTest() {
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> dis(-1000, 1000);
+    TTree tree;
+    for (int i = 0; i < (1 << 16); i++) {
+        tree.insert(dis(gen), dis(gen));
+    }
+    std::vector<Point> updates;
+    std::uniform_real_distribution<> angle(0, 6.283185307179586);
+    for (int i = 0; i < 1024; i++) {
+        double a = angle(gen);
+        updates.emplace_back(1500 * std::cos(a), 1500 * std::sin(a));
+    }
+    auto run = [&](const char *name, int threads, auto makeReader, auto query) {
+        std::atomic<bool> stop{false};
+        std::atomic<long long> total{0};
+        long long writes = 0;
+        std::vector<std::thread> readers;
+        for (int t = 0; t < threads; t++) {
+            readers.emplace_back([&, t]() {
+                auto reader = makeReader();
+                std::mt19937 local(t + 1);
+                long long count = 0;
+                while (not stop.load(std::memory_order_relaxed)) {
+                    for (int i = 0; i < 256; i++) count += query(*reader, dis(local), dis(local));
+                }
+                total += count;
+            });
+        }
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500)) {
+            Point &p = updates[writes % updates.size()];
+            tree.insert(p.x, p.y);
+            tree.remove(p);
+            writes += 2;
+        }
+        stop = true;
+        for (std::thread &thread: readers) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << " with " << threads << " readers: " << total / seconds / 1e6
+                  << " million queries per second, " << writes / seconds << " updates per second" << std::endl;
+    };
+    for (int threads: {1, 2, 4, 8}) {
+        SnapshotPublisher publisher(tree);
+        run("SnapshotPublisher", threads, [&]() { return std::make_unique<SnapshotPublisher::Reader>(publisher); },
+            [](SnapshotPublisher::Reader &reader, double x, double y) { return reader.contains(x, y); });
+    }
+    for (int threads: {1, 2, 4, 8}) {
+        PersistentHull hull(tree);
+        run("PersistentHull", threads, [&]() { return std::make_unique<PersistentHull::Reader>(hull); },
+            [](PersistentHull::Reader &reader, double x, double y) { return reader.contains(Point(x, y)); });
+    }
+}
+
+/**
+ * @brief Runs producer threads against an UpdateService and prints its metrics. Every producer keeps a window of
+ * updates in flight, so batches grow with the number of producers.
+ */
+void timer::updateServiceTest() {
+    TTree tree;
+    SnapshotPublisher publisher(tree, false);
+    int perThread = 1 << 15;
+    for (int producers: {1, 2, 4, 8}) {
+        UpdateService service(tree, [&]() { publisher.publish(); });
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < producers; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 gen(t + 1);
+                std::uniform_real_distribution<> dis(-1000, 1000);
+                std::vector<std::future<bool>> window;
+                for (int i = 0; i < perThread; i++) {
+                    Point p(dis(gen), dis(gen));
+                    window.push_back(service.insert(p));
+                    // Every other point is removed again, often in the same batch
+                    if (i % 2 == 0) window.push_back(service.remove(p));
+                    if (window.size() >= 64) {
+                        for (auto &f: window) f.get();
+                        window.clear();
+                    }
+                }
+                for (auto &f: window) f.get();
+            });
+        }
+        for (std::thread &thread: threads) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        UpdateService::Metrics m = service.metrics();
+        std::cout << producers << " producers: " << m.updates / seconds / 1e3 << " thousand updates per second, "
+                  << m.batches << " batches, " << m.applied << " applied to the tree, mean latency "
+                  << m.totalLatency / m.updates / 1e3 << "us, max " << m.maxLatency / 1e3 << "us" << std::endl;
+        std::cout << "  batch sizes:";
+        for (int i = 0; i < UpdateService::BUCKETS; i++) {
+            if (m.batchSizes[i] != 0) std::cout << " " << (1 << i) << ":" << m.batchSizes[i];
+        }
+        std::cout << std::endl;
+    }
+}
+
+/**
+ * @brief Inserts the same points from 4 producer threads into a ShardedHull with 1, 2, 4 and 8 shards. Half the
+ * points fall in a narrow range left of the rest, so the shards only stay even by rebalancing.
+ */
+void timer::shardTest() {
+    int count = 1 << 17;
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> dis(-1000, 1000);
+    std::vector<Point> points;
+    for (int i = 0; i < count; i++) {
+        double x = i % 2 == 0 ? dis(gen) / 100 - 900 : dis(gen);
+        points.emplace_back(x, dis(gen));
+    }
+    for (int shards: {1, 2, 4, 8}) {
+        ShardedHull hull(shards, -1000, 1000);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; t++) {
+            producers.emplace_back([&, t]() {
+                std::vector<std::future<bool>> window;
+                for (int i = t; i < count; i += 4) {
+                    window.push_back(hull.insert(points[i]));
+                    if (window.size() >= 64) {
+                        for (auto &f: window) f.get();
+                        window.clear();
+                    }
+                }
+                for (auto &f: window) f.get();
+            });
+        }
+        for (std::thread &thread: producers) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::size_t vertices = hull.getHull().size();
+        std::cout << shards << " shards: " << count / seconds / 1e3 << " thousand inserts per second, " << vertices
+                  << " hull vertices, points per shard:";
+        for (auto &shard: hull.shards) std::cout << " " << shard->points();
+        std::cout << std::endl;
+    }
+}
+
+/**
+ * @brief Compares the update latency of a TTree against maintaining its two hulls on two threads, either sharing the
+ * skeleton (ParallelTTree) or with a skeleton each (SplitTTree).
+ */
+void timer::chainTest() {
+    int count = 1 << 17;
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<> dis(-1000, 1000);
+    std::vector<Point> points;
+    for (int i = 0; i < count; i++) points.emplace_back(dis(gen), dis(gen));
+    std::cout << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    auto time = [&](const char *name, auto &tree) {
+        auto start = std::chrono::steady_clock::now();
+        for (Point &p: points) tree.insert(p);
+        auto middle = std::chrono::steady_clock::now();
+        for (Point &p: points) tree.remove(p);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << name << ": insert " << std::chrono::duration<double>(middle - start).count() * 1e9 / count
+                  << " ns, remove " << std::chrono::duration<double>(end - middle).count() * 1e9 / count << " ns"
+                  << std::endl;
+    };
+    TTree tree;
+    time("TTree", tree);
+    ParallelTTree parallel;
+    time("ParallelTTree", parallel);
+    SplitTTree split;
+    time("SplitTTree", split);
+}
+
+/**
+ * @brief Fills a HullMap with 2^18 keys of 8 points each from 1, 2, 4 and 8 threads and prints the throughput and the
+ * memory per hull, then grows some of the keys past the small hull limit to compare.
+ */
+void timer::hullMapTest() {
+    int keys = 1 << 18;
+    int perKey = 8;
+    for (int threads: {1, 2, 4, 8}) {
+        HullMap<std::uint64_t> map;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                std::mt19937 gen(t + 1);
+                std::uniform_real_distribution<> dis(-1000, 1000);
+                for (long i = t; i < static_cast<long>(keys) * perKey; i += threads) {
+                    map.insert(static_cast<std::uint64_t>(i % keys), Point(dis(gen), dis(gen)));
+                }
+            });
+        }
+        for (std::thread &worker: workers) worker.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        HullMap<std::uint64_t>::MemoryUsage usage = map.memoryUsage();
+        std::cout << threads << " threads: " << static_cast<double>(keys) * perKey / seconds / 1e6
+                  << " million inserts per second, " << usage.bytes / usage.hulls << " bytes per hull" << std::endl;
+        if (threads != 8) continue;
+        std::mt19937 gen(0);
+        std::uniform_real_distribution<> dis(-1000, 1000);
+        for (std::uint64_t key = 0; key < 1024; key++) {
+            for (int i = 0; i < 64; i++) map.insert(key, Point(dis(gen), dis(gen)));
+        }
+        usage = map.memoryUsage();
+        std::cout << usage.small << " small hulls of " << perKey << " points: " << usage.smallBytes / usage.small
+                  << " bytes each, " << usage.large << " TTree hulls of " << perKey + 64 << " points: "
+                  << usage.largeBytes / usage.large << " bytes each" << std::endl;
+    }
+}
+
+/**
+ * @brief Times inserting and removing the same integer points in a double and an integral TTree, once on a small grid
+ * and once spread over the whole 32 bit range.
+ */
+void timer::integerTest() {
+    int count = 1 << 17;
+    std::mt19937 gen(0);
+    for (std::int64_t range: {std::int64_t(1) << 12, std::int64_t(1) << 31}) {
+        std::uniform_int_distribution<std::int64_t> dis(-range, range - 1);
+        std::vector<Point> points;
+        for (int i = 0; i < count; i++) points.emplace_back(dis(gen), dis(gen));
+        for (bool integral: {false, true}) {
+            TTree tree(integral);
+            auto start = std::chrono::steady_clock::now();
+            for (Point &p: points) tree.insert(p);
+            for (Point &p: points) tree.remove(p);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << (integral ? "integral" : "double") << " TTree, coordinates below " << range << ": "
+                      << 1e9 * seconds / (2 * count) << " ns per update" << std::endl;
+        }
+    }
+}
+
+/**
+ * @brief Times the orientation test against the plain determinant on random points, then inserting and removing
+ * points of random and degenerate sets in a TTree. The hull sizes show whether the degenerate sets came out right, all
+ * points of the integer parabola are on the lower hull and the grid has its boundary on the hull.
+ */
+void timer::predicateTest() {
+    int count = 1 << 20;
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> dis(-1, 1);
+    std::vector<Point> points;
+    for (int i = 0; i < count + 2; i++) points.emplace_back(dis(gen), dis(gen));
+    int turns = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) turns += Angle::orientation(points[i], points[i + 1], points[i + 2]) > 0;
+    double plain = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) turns += Angle::turn(points[i], points[i + 1], points[i + 2]) > 0;
+    double filtered = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "plain determinant: " << 1e9 * plain / count << " ns, filtered turn: " << 1e9 * filtered / count
+              << " ns per test (" << turns << " left turns)" << std::endl;
+
+    int n = 1 << 17;
+    int side = static_cast<int>(std::sqrt(n));
+    std::vector<std::pair<std::string, std::vector<Point>>> sets(5);
+    sets[0].first = "random";
+    for (int i = 0; i < n; i++) sets[0].second.emplace_back(dis(gen), dis(gen));
+    sets[1].first = "grid";
+    for (int i = 0; i < side; i++) {
+        for (int j = 0; j < side; j++) sets[1].second.emplace_back(i, j);
+    }
+    sets[2].first = "integer parabola";
+    for (int i = -n / 2; i < n / 2; i++) sets[2].second.emplace_back(i, static_cast<double>(i) * i);
+    sets[3].first = "rounded parabola";
+    for (int i = -n / 2; i < n / 2; i++) sets[3].second.emplace_back(i * 1e-3, (i * 1e-3) * (i * 1e-3));
+    sets[4].first = "rounded line";
+    for (int i = -n / 2; i < n / 2; i++) sets[4].second.emplace_back(i * 0.1, 0.3 * (i * 0.1) + 0.7);
+    for (auto &[name, set]: sets) {
+        std::shuffle(set.begin(), set.end(), gen);
+        TTree tree;
+        start = std::chrono::steady_clock::now();
+        for (Point &p: set) tree.insert(p);
+        int hull = tree.size();
+        for (Point &p: set) tree.remove(p);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << 1e9 * seconds / (2 * set.size()) << " ns per update, " << hull
+                  << " hull vertices of " << set.size() << " points" << std::endl;
+    }
+}
+
+// The vertices of the hull of points in counter clockwise order without collinear ones, by the monotone chain algorithm
+static std::vector<Point> strictHull(std::vector<Point> points) {
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    if (points.size() <= 2) return points;
+    std::vector<Point> hull;
+    for (const Point &p: points) {
+        while (hull.size() >= 2 and Angle::turn(hull[hull.size() - 2], hull.back(), p) <= 0) hull.pop_back();
+        hull.push_back(p);
+    }
+    std::size_t lower = hull.size();
+    for (auto it = points.rbegin() + 1; it != points.rend(); ++it) {
+        while (hull.size() > lower and Angle::turn(hull[hull.size() - 2], hull.back(), *it) <= 0) hull.pop_back();
+        hull.push_back(*it);
+    }
+    hull.pop_back();
+    return hull;
+}
+
+// The distance from p to the boundary of a hull in counter clockwise order, brute force over its edges
+static double boundaryDistance(const Point &p, const std::vector<Point> &hull) {
+    double distance = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < hull.size(); i++) {
+        const Point &a = hull[i];
+        const Point &b = hull[(i + 1) % hull.size()];
+        double dx = b.x - a.x;
+        double dy = b.y - a.y;
+        double lengthSquared = dx * dx + dy * dy;
+        double t = lengthSquared == 0 ? 0 : std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared, 0.0, 1.0);
+        distance = std::min(distance, std::hypot(p.x - a.x - t * dx, p.y - a.y - t * dy));
+    }
+    return distance;
+}
+
+/**
+ * @brief Checks queries on small integer grids against brute force and prints the number of mismatches
+ * @details Grid points make collinear vertices, several vertices at one x and vertical hull edges common, which random
+ * doubles practically never produce. Every query point of the surrounding grid is tested, so queries also lie on the
+ * lines through edges and at the x coordinates of vertical edges.
+ */
+void timer::gridTest() {
+    std::mt19937 gen(0);
+    int trials = 2000;
+    long queries = 0;
+    long tangentErrors = 0;
+    long containsErrors = 0;
+    long caliperErrors = 0;
+    long distanceErrors = 0;
+    auto differs = [](double a, double b) { return std::abs(a - b) > 1e-9 * std::max(1.0, std::abs(b)); };
+    for (int trial = 0; trial < trials; trial++) {
+        int radius = 2 + static_cast<int>(gen() % 8);
+        std::uniform_int_distribution<int> coordinate(-radius, radius);
+        TTree tree;
+        std::vector<Point> points;
+        int n = 3 + static_cast<int>(gen() % 20);
+        for (int i = 0; i < n; i++) {
+            points.emplace_back(coordinate(gen), coordinate(gen));
+            tree.insert(points.back());
+        }
+        std::vector<Point> hull = strictHull(points);
+        std::size_t h = hull.size();
+        if (h < 3) continue;
+        double diameter = 0;
+        double width = std::numeric_limits<double>::infinity();
+        double area = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < h; i++) {
+            Point a = hull[i];
+            Point b = hull[(i + 1) % h];
+            double length = std::hypot(b.x - a.x, b.y - a.y);
+            double height = 0;
+            double low = 0;
+            double high = 0;
+            for (const Point &p: hull) {
+                diameter = std::max(diameter, std::hypot(p.x - a.x, p.y - a.y));
+                height = std::max(height, Angle::orientation(a, b, p) / length);
+                double along = ((b.x - a.x) * (p.x - a.x) + (b.y - a.y) * (p.y - a.y)) / length;
+                low = std::min(low, along);
+                high = std::max(high, along);
+            }
+            width = std::min(width, height);
+            area = std::min(area, height * (high - low));
+        }
+        caliperErrors += differs(tree.diameter(), diameter) + differs(tree.width(), width) +
+                         differs(tree.minAreaRectangle().area, area);
+        // The batched boundaryDistance starts each query from the nearest edge of the one before
+        std::vector<Point> grid;
+        for (int x = -radius - 2; x <= radius + 2; x++) {
+            for (int y = -radius - 2; y <= radius + 2; y++) grid.emplace_back(x, y);
+        }
+        std::vector<double> distances = tree.boundaryDistance(grid);
+        for (std::size_t k = 0; k < grid.size(); k++) {
+            double expected = boundaryDistance(grid[k], hull);
+            distanceErrors += differs(distances[k], expected) + differs(tree.boundaryDistance(grid[k]), expected);
+        }
+        for (int x = -radius - 2; x <= radius + 2; x++) {
+            for (int y = -radius - 2; y <= radius + 2; y++) {
+                Point q(x, y);
+                queries++;
+                // The visible edges form one run, which starts where the edge before is not visible
+                std::optional<std::pair<Point, Point>> expected;
+                for (std::size_t i = 0; i < h; i++) {
+                    bool visible = Angle::turn(hull[i], hull[(i + 1) % h], q) < 0;
+                    bool previous = Angle::turn(hull[(i + h - 1) % h], hull[i], q) < 0;
+                    if (visible and not previous) expected = std::make_pair(hull[i], hull[i]);
+                }
+                if (expected) {
+                    for (std::size_t i = 0; i < h; i++) {
+                        bool visible = Angle::turn(hull[i], hull[(i + 1) % h], q) < 0;
+                        bool previous = Angle::turn(hull[(i + h - 1) % h], hull[i], q) < 0;
+                        if (previous and not visible) expected->second = hull[i];
+                    }
+                }
+                tangentErrors += tree.tangents(q) != expected;
+                containsErrors += tree.contains(q) != not expected.has_value();
+            }
+        }
+    }
+    std::cout << trials << " grids, " << queries << " queries" << std::endl;
+    std::cout << "tangents: " << tangentErrors << " errors" << std::endl;
+    std::cout << "contains: " << containsErrors << " errors" << std::endl;
+    std::cout << "diameter, width and minAreaRectangle: " << caliperErrors << " errors" << std::endl;
+    std::cout << "boundaryDistance: " << distanceErrors << " errors" << std::endl;
+
+    // Updates of a tree with an observer, whose deltas must turn the hull before each update into the hull after it.
+    // A PersistentHull follows the same deltas and must publish the hull of the tree after every update, and
+    // boundaryDistance must answer for the new hull right after it.
+    long updates = 0;
+    long deltaErrors = 0;
+    long versionErrors = 0;
+    long updateDistanceErrors = 0;
+    for (int trial = 0; trial < trials; trial++) {
+        int radius = 2 + static_cast<int>(gen() % 8);
+        std::uniform_int_distribution<int> coordinate(-radius, radius);
+        TTree tree;
+        HullDelta delta;
+        tree.addHullObserver([&](const HullDelta &d) { delta = d; });
+        PersistentHull persistent(tree);
+        PersistentHull::Reader reader(persistent);
+        std::vector<Point> hull;
+        std::vector<Point> points;
+        for (int i = 0; i < 60; i++) {
+            Point p(coordinate(gen), coordinate(gen));
+            delta = HullDelta();
+            bool changed = gen() % 3 == 0 ? tree.remove(p) : tree.insert(p);
+            if (changed) {
+                auto it = std::find(points.begin(), points.end(), p);
+                if (it == points.end()) {
+                    points.push_back(p);
+                } else {
+                    points.erase(it);
+                }
+            }
+            std::vector<Point> expected = tree.getHull();
+            if (not changed) continue;
+            updates++;
+            versionErrors += reader.getHull() != expected;
+            if (not points.empty()) {
+                std::vector<Point> queries{p, Point(0, 0), Point(radius, -radius)};
+                std::vector<double> distances = tree.boundaryDistance(queries);
+                std::vector<Point> strict = strictHull(points);
+                for (std::size_t k = 0; k < queries.size(); k++) {
+                    updateDistanceErrors += differs(distances[k], boundaryDistance(queries[k], strict));
+                }
+            }
+            std::sort(hull.begin(), hull.end());
+            for (const Point &q: delta.left) {
+                auto it = std::lower_bound(hull.begin(), hull.end(), q);
+                if (it == hull.end() or *it != q) {
+                    deltaErrors++;
+                } else {
+                    hull.erase(it);
+                }
+            }
+            hull.insert(hull.end(), delta.entered.begin(), delta.entered.end());
+            std::sort(hull.begin(), hull.end());
+            // A hull that is a segment lists its inner points once per side
+            std::sort(expected.begin(), expected.end());
+            expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+            deltaErrors += hull != expected;
+            hull = expected;
+        }
+    }
+    std::cout << updates << " updates" << std::endl;
+    std::cout << "insert and remove deltas: " << deltaErrors << " errors" << std::endl;
+    std::cout << "PersistentHull versions: " << versionErrors << " errors" << std::endl;
+    std::cout << "boundaryDistance after updates: " << updateDistanceErrors << " errors" << std::endl;
+}
@@ -16,6 +16,17 @@ class timer {
 
 public:
     void addTest();
+    void containsTest();
+    void envelopeTest();
+    void halfPlaneTest();
+    void publishTest();
+    void updateServiceTest();
+    void shardTest();
+    void chainTest();
+    void hullMapTest();
+    void integerTest();
+    void predicateTest();
+    void gridTest();
 };
 
 